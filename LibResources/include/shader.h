@@ -10,6 +10,7 @@
 #include <QtGui/qopenglfunctions_3_3_core.h>
 
 #include <string>
+#include <unordered_map>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -110,6 +111,8 @@ public:
 		if (geometryPath != nullptr)
 			f->glDeleteShader(geometry);
 
+		cacheUniforms();
+
 		use();
 
 	}
@@ -119,66 +122,125 @@ public:
 	{
 		f->glUseProgram(ID);
 	}
+
+	// location of a uniform from the table filled at link time (-1 if the program does not use it, which gl ignores)
+	int getLocation(const std::string &name) const
+	{
+		auto found = locations.find(name);
+
+		if (found == locations.end()) {
+			return -1;
+		}
+
+		return found->second;
+	}
+
+	// connect a uniform block of the program to a binding point (see UniformBuffer)
+	void bindUniformBlock(const char* name, unsigned int binding)
+	{
+		unsigned int index = f->glGetUniformBlockIndex(ID, name);
+
+		if (index != GL_INVALID_INDEX) {
+			f->glUniformBlockBinding(ID, index, binding);
+		}
+	}
+
 	// utility uniform functions
+	// the name versions look the location up in the cached table, the location versions skip even that
 	
 	void setBool(const std::string &name, bool value) const
 	{
-		f->glUniform1i(f->glGetUniformLocation(ID, name.c_str()), (int)value);
+		f->glUniform1i(getLocation(name), (int)value);
 	}
 	
 	void setInt(const std::string &name, int value) const
 	{
-		f->glUniform1i(f->glGetUniformLocation(ID, name.c_str()), value);
+		f->glUniform1i(getLocation(name), value);
 	}
 	
 	void setFloat(const std::string &name, float value) const
 	{
-		f->glUniform1f(f->glGetUniformLocation(ID, name.c_str()), value);
+		f->glUniform1f(getLocation(name), value);
 	}
 	
 	void setVec2(const std::string &name, const glm::vec2 &value) const
 	{
-		f->glUniform2fv(f->glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+		f->glUniform2fv(getLocation(name), 1, &value[0]);
 	}
 	void setVec2(const std::string &name, float x, float y) const
 	{
-		f->glUniform2f(f->glGetUniformLocation(ID, name.c_str()), x, y);
+		f->glUniform2f(getLocation(name), x, y);
 	}
 	
 	void setVec3(const std::string &name, const glm::vec3 &value) const
 	{
-		f->glUniform3fv(f->glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+		f->glUniform3fv(getLocation(name), 1, &value[0]);
 	}
 	void setVec3(const std::string &name, float x, float y, float z) const
 	{
-		f->glUniform3f(f->glGetUniformLocation(ID, name.c_str()), x, y, z);
+		f->glUniform3f(getLocation(name), x, y, z);
 	}
 	
 	void setVec4(const std::string &name, const glm::vec4 &value) const
 	{
-		f->glUniform4fv(f->glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+		f->glUniform4fv(getLocation(name), 1, &value[0]);
 	}
 	void setVec4(const std::string &name, float x, float y, float z, float w)
 	{
-		f->glUniform4f(f->glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+		f->glUniform4f(getLocation(name), x, y, z, w);
 	}
 	
 	void setMat2(const std::string &name, const glm::mat2 &mat) const
 	{
-		f->glUniformMatrix2fv(f->glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		f->glUniformMatrix2fv(getLocation(name), 1, GL_FALSE, &mat[0][0]);
 	}
 	
 	void setMat3(const std::string &name, const glm::mat3 &mat) const
 	{
-		f->glUniformMatrix3fv(f->glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		f->glUniformMatrix3fv(getLocation(name), 1, GL_FALSE, &mat[0][0]);
 	}
 	
 	void setMat4(const std::string &name, const glm::mat4 &mat) const
 	{
-		f->glUniformMatrix4fv(f->glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		f->glUniformMatrix4fv(getLocation(name), 1, GL_FALSE, &mat[0][0]);
 	}
 
 private:
+	// uniform name -> location for every active uniform of the program
+	std::unordered_map<std::string, int> locations;
+
+	// ask the program for all of its uniforms once so the setters never have to
+	void cacheUniforms()
+	{
+		locations.clear();
+
+		GLint count = 0;
+		f->glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+
+		for (GLint i = 0; i < count; i++)
+		{
+			GLchar name[256];
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type;
+			f->glGetActiveUniform(ID, i, sizeof(name), &length, &size, &type, name);
+
+			// uniforms inside blocks have no location
+			int location = f->glGetUniformLocation(ID, name);
+			if (location == -1) {
+				continue;
+			}
+
+			std::string uniform(name, length);
+			locations[uniform] = location;
+
+			// arrays are reported as "name[0]" but are usually set as "name"
+			if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0) {
+				locations[uniform.substr(0, uniform.size() - 3)] = location;
+			}
+		}
+	}
+
 	// utility function for checking shader compilation/linking errors.
 	
 	void checkCompileErrors(GLuint shader, std::string type)
@@ -20,6 +20,8 @@
 #include "Graph.h"
 #include "UnfoldSolution.h"
 #include "Unfold.h"
+#include "BackgroundWorker.h"
+#include "ThreadPool.h"
 
 class Animator {
 public:
@@ -32,7 +34,7 @@ public:
 		// which of the available algortihms is being used
 		int activeAlgorithm;
 
-		// milliseconds for animation to complete
+		// multiplier on the base unfold rate (1 unfolds the shape in secondsPerUnfold)
 		float speed;
 
 		float progress;
@@ -83,50 +85,113 @@ public:
 		}
 	};
 
+	// a pose to work out on the worker (copied out of the animation so the ui can change the animation meanwhile)
+	struct PoseJob {
+		Shape* shape;
+		int algorithm;
+		float progress;
+	};
+
+	// pose the shapes across every core instead of one after the other on the worker
+	bool parallel = true;
+
+	// seconds a whole unfold takes at speed 1 (the old fixed step of 1/750 per frame at 60 fps)
+	static constexpr float secondsPerUnfold = 12.5f;
+
 	Animator() {
 		animations = new vector<Animation>();
+		worker = new BackgroundWorker();
+		pool = new ThreadPool();
 	}
 
-	// main update function for all animations
-	void update() {
+	// main update function for all animations (call once per frame on the gl thread with the seconds since the last frame)
+	// the poses are a frame behind: this shows the poses the worker made during the last frame and then
+	// starts it on the poses for the next one, so the cpu work overlaps drawing instead of holding up the ui
+	void update(float seconds) {
+		finish();
+
+		present();
+
+		vector<PoseJob> jobs;
+
 		for (int i = 0; i < animations->size(); i++) {
 			if ((*animations)[i].shape->unfold != nullptr && !(*animations)[i].paused) {
 				if ((*animations)[i].progress < 0.0f) {
 					// revert the shape to default position since we round up to 0 from negative progress
 					(*animations)[i].shape->revert();
 
+					// a cpu posed shape has to upload its reverted vertices (a gpu posed one reads the reset transforms)
+					if (!(*animations)[i].shape->gpuPose) {
+						(*animations)[i].shape->model->rebuildMeshes();
+					}
+
 					(*animations)[i].progress = 0.0f;
 				}
 				else if ((*animations)[i].progress < 1.0f) {
-					// identify which algorithm to use
-					switch ((*animations)[i].activeAlgorithm) {
-					case 0: {
-						Unfold::stepBasedUpdate((*animations)[i].shape, (*animations)[i].shape->unfold, (*animations)[i].progress);
-						break;
-					}
-					case 1: {
-						Unfold::breadthFirstUpdate((*animations)[i].shape, (*animations)[i].shape->unfold, (*animations)[i].progress);
-						break;
-					}
-					}
+					jobs.push_back({ (*animations)[i].shape, (*animations)[i].activeAlgorithm, (*animations)[i].progress });
 
-					//if (!(*animations)[i].paused) {
-					//std::cout << (*animations)[i].progress << std::endl;
-					(*animations)[i].progress += (*animations)[i].speed / (100 * 7.5f);
-					//}
+					(*animations)[i].progress += (*animations)[i].speed * seconds / secondsPerUnfold;
 				}
 				else if ((*animations)[i].progress > 1.0f) {
 					(*animations)[i].progress = 1.0f;
 
-					Unfold::breadthFirstUpdate((*animations)[i].shape, (*animations)[i].shape->unfold, (*animations)[i].progress);
+					jobs.push_back({ (*animations)[i].shape, 1, (*animations)[i].progress });
+				}
+			}
+		}
+
+		if (!jobs.empty()) {
+			ThreadPool* pool = parallel ? this->pool : nullptr;
+
+			// shapes share nothing so each one can be posed on its own thread
+			// (only the cpu side is touched, the gl uploads all happen in present)
+			worker->start([jobs, pool]() {
+				if (pool != nullptr) {
+					pool->parallelFor(jobs.size(), [&](int i) {
+						pose(jobs[i]);
+					});
 				}
+				else {
+					for (int i = 0; i < jobs.size(); i++) {
+						pose(jobs[i]);
+					}
+				}
+			});
+		}
+	}
+
+	// wait for the worker to finish the poses it is working on
+	// call before changing a shape that is animating (its unfold, its vertices or its position from getBasePos)
+	void finish() {
+		worker->wait();
+	}
 
-				// rebuild the mesh for each shape
-				(*animations)[i].shape->model->rebuildMeshes();
+	// swap the finished poses in and send the vertices of cpu posed shapes to the gpu (gl thread only)
+	void present() {
+		for (int i = 0; i < animations->size(); i++) {
+			Shape* shape = (*animations)[i].shape;
+
+			if (shape->presentPose() && !shape->gpuPose) {
+				shape->model->rebuildMeshes();
 			}
 		}
 	}
 
+	// work out the pose of one shape (only touches the cpu side of the shape)
+	static void pose(const PoseJob &job) {
+		// identify which algorithm to use
+		switch (job.algorithm) {
+		case 0: {
+			Unfold::stepBasedUpdate(job.shape, &job.shape->unfoldTree, job.progress);
+			break;
+		}
+		case 1: {
+			Unfold::breadthFirstUpdate(job.shape, &job.shape->unfoldTree, job.progress);
+			break;
+		}
+		}
+	}
+
 	// check if the animation for the shape already exists and if not then create it
 	void addAnimation(Shape* shape, bool paused = false, int algorithm = 1, float speed = 1) {
 		bool found = false;
@@ -147,6 +212,12 @@ public:
 
 private:
 	vector<Animation>* animations;
+
+	// works out the poses of the next frame
+	BackgroundWorker* worker;
+
+	// splits the poses of a frame between the cores
+	ThreadPool* pool;
 };
 
 #endif
\ No newline at end of file
@@ -30,6 +30,12 @@ public:
 	// overrides the rotation variable and makes sure the model stays rotated when rotation is reset to vec3(0)
 	glm::vec3 localRotation;
 
+	// set this after changing position, rotation or scale directly (the setters do it)
+	bool transformDirty = true;
+
+	// transform of each mesh applied by the gpu (the mesh's face id picks its entry), nullptr to draw the vertices as they are
+	vector<glm::mat4>* meshTransforms = nullptr;
+
 	Asset() {
 
 	}
@@ -70,10 +76,12 @@ public:
 
 	void setPosition(glm::vec3 position) {
 		this->position = position;
+		transformDirty = true;
 	}
 
 	void setRotation(glm::vec3 rotation) {
 		this->rotation = rotation;
+		transformDirty = true;
 
 		if (this->rotation.x > 360) {
 			this->rotation.x = this->rotation.x - 360;
@@ -99,7 +107,27 @@ public:
 
 	void setScale(glm::vec3 scale) {
 		this->scale = scale;
+		transformDirty = true;
 	}
+
+	// position * rotation * scale, only rebuilt after the transform changed
+	glm::mat4 &getModelMatrix() {
+		if (transformDirty) {
+			modelMatrix = glm::mat4(1.0f);
+			modelMatrix = glm::translate(modelMatrix, position);
+			modelMatrix = glm::rotate(modelMatrix, glm::radians(rotation.x), glm::vec3(1.0, 0.0, 0.0));
+			modelMatrix = glm::rotate(modelMatrix, glm::radians(rotation.y), glm::vec3(0.0, 1.0, 0.0));
+			modelMatrix = glm::rotate(modelMatrix, glm::radians(rotation.z), glm::vec3(0.0, 0.0, 1.0));
+			modelMatrix = glm::scale(modelMatrix, scale);
+
+			transformDirty = false;
+		}
+
+		return modelMatrix;
+	}
+
+private:
+	glm::mat4 modelMatrix = glm::mat4(1.0f);
 };
 
 #endif
\ No newline at end of file
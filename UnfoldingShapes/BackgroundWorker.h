@@ -0,0 +1,90 @@
+#ifndef BACKGROUNDWORKER_H
+#define BACKGROUNDWORKER_H
+
+#include <iostream>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+// a thread that runs one job at a time so the caller can keep going and collect the result later
+// (start hands over the next job, wait blocks until the current one is done)
+class BackgroundWorker {
+public:
+	BackgroundWorker() {
+		worker = thread(&BackgroundWorker::loop, this);
+	}
+
+	~BackgroundWorker() {
+		{
+			lock_guard<mutex> lock(jobLock);
+			stopping = true;
+		}
+		jobChanged.notify_all();
+
+		worker.join();
+	}
+
+	BackgroundWorker(const BackgroundWorker&) = delete;
+	BackgroundWorker& operator=(const BackgroundWorker&) = delete;
+
+	// run job on the worker (waits for the job before it first)
+	void start(function<void()> job) {
+		unique_lock<mutex> lock(jobLock);
+		jobChanged.wait(lock, [this]() { return !running; });
+
+		this->job = job;
+		running = true;
+
+		lock.unlock();
+		jobChanged.notify_all();
+	}
+
+	// block until the worker has nothing left to do
+	void wait() {
+		unique_lock<mutex> lock(jobLock);
+		jobChanged.wait(lock, [this]() { return !running; });
+	}
+
+	bool busy() {
+		lock_guard<mutex> lock(jobLock);
+		return running;
+	}
+
+private:
+	thread worker;
+
+	mutex jobLock;
+	condition_variable jobChanged;
+
+	function<void()> job;
+	bool running = false;
+	bool stopping = false;
+
+	void loop() {
+		while (true) {
+			unique_lock<mutex> lock(jobLock);
+			jobChanged.wait(lock, [this]() { return running || stopping; });
+
+			if (!running && stopping) {
+				return;
+			}
+
+			function<void()> current = job;
+			lock.unlock();
+
+			current();
+
+			lock.lock();
+			job = nullptr;
+			running = false;
+			lock.unlock();
+
+			jobChanged.notify_all();
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef DISJOINTSET_H
+#define DISJOINTSET_H
+
+#include <vector>
+
+using namespace std;
+
+// union-find over the integers 0..count-1 (union by size with path halving so every operation is nearly constant time)
+class DisjointSet {
+public:
+	DisjointSet(unsigned int count = 0) {
+		reset(count);
+	}
+
+	// every element starts in its own set
+	void reset(unsigned int count) {
+		parent.resize(count);
+		setSize.assign(count, 1);
+
+		for (unsigned int i = 0; i < count; i++) {
+			parent[i] = i;
+		}
+
+		sets = count;
+	}
+
+	// returns the representative of the set containing i
+	unsigned int find(unsigned int i) {
+		while (parent[i] != i) {
+			parent[i] = parent[parent[i]];
+			i = parent[i];
+		}
+
+		return i;
+	}
+
+	// merge the sets of a and b (returns false if they were already in the same set)
+	bool join(unsigned int a, unsigned int b) {
+		a = find(a);
+		b = find(b);
+
+		if (a == b) {
+			return false;
+		}
+
+		// attach the smaller set under the larger one
+		if (setSize[a] < setSize[b]) {
+			unsigned int temp = a;
+			a = b;
+			b = temp;
+		}
+
+		parent[b] = a;
+		setSize[a] += setSize[b];
+
+		sets--;
+
+		return true;
+	}
+
+	bool connected(unsigned int a, unsigned int b) {
+		return find(a) == find(b);
+	}
+
+	// number of seperate sets left
+	unsigned int count() {
+		return sets;
+	}
+
+	unsigned int size() {
+		return parent.size();
+	}
+
+private:
+	vector<unsigned int> parent;
+	vector<unsigned int> setSize;
+
+	unsigned int sets;
+};
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef EDGEINDEX_H
+#define EDGEINDEX_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// a point snapped onto a grid, used to find the cell a point falls in
+struct QuantizedPoint {
+	int64_t x, y, z;
+
+	bool operator==(const QuantizedPoint& p) const {
+		return x == p.x && y == p.y && z == p.z;
+	}
+};
+
+struct QuantizedPointHash {
+	size_t operator()(const QuantizedPoint& p) const {
+		// mix every coordinate into one value (boost style hash_combine)
+		uint64_t h = 0;
+		const int64_t values[3] = { p.x, p.y, p.z };
+
+		for (int i = 0; i < 3; i++) {
+			h ^= (uint64_t)values[i] + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+		}
+
+		return (size_t)h;
+	}
+};
+
+inline QuantizedPoint quantizePoint(glm::vec3 p, float cellSize) {
+	QuantizedPoint q;
+
+	q.x = (int64_t)std::llround((double)p.x / cellSize);
+	q.y = (int64_t)std::llround((double)p.y / cellSize);
+	q.z = (int64_t)std::llround((double)p.z / cellSize);
+
+	return q;
+}
+
+// undirected edge between two welded points (the smaller id is always stored first so a->b and b->a match)
+struct EdgeKey {
+	int a, b;
+
+	EdgeKey(int p1, int p2) {
+		a = min(p1, p2);
+		b = max(p1, p2);
+	}
+
+	bool operator==(const EdgeKey& e) const {
+		return a == e.a && b == e.b;
+	}
+};
+
+struct EdgeKeyHash {
+	size_t operator()(const EdgeKey& e) const {
+		return (size_t)(((uint64_t)(uint32_t)e.a << 32) ^ (uint64_t)(uint32_t)e.b);
+	}
+};
+
+// maps every undirected edge to the ids of the elements (triangles, axis, ...) that use it.
+// the end points are welded first: a point within cellSize of one seen before takes its id, the cell of the point and the
+// cells around it are searched so two close points on either side of a cell border still match.
+// building the index is linear in the number of edges and each lookup is constant time.
+class EdgeIndex {
+public:
+	// edge -> ids of everything added along that edge
+	unordered_map<EdgeKey, vector<unsigned int>, EdgeKeyHash> edges;
+
+	// size of the snapping grid, points closer than this are treated as the same point
+	float cellSize;
+
+	EdgeIndex(float cellSize = 0.0001f) {
+		this->cellSize = cellSize;
+	}
+
+	void reserve(size_t edgeCount) {
+		edges.reserve(edgeCount);
+		cells.reserve(edgeCount);
+		points.reserve(edgeCount);
+	}
+
+	void clear() {
+		edges.clear();
+		cells.clear();
+		points.clear();
+	}
+
+	// returns the id of the welded point p snaps to, a new one is made if there is none close enough
+	int weld(glm::vec3 p) {
+		int id = findWeld(p);
+
+		if (id == -1) {
+			id = points.size();
+			points.push_back(p);
+			cells[quantizePoint(p, cellSize)].push_back(id);
+		}
+
+		return id;
+	}
+
+	// same without adding anything (-1 if no welded point is close enough)
+	int findWeld(glm::vec3 p) {
+		QuantizedPoint q = quantizePoint(p, cellSize);
+
+		for (int x = -1; x <= 1; x++) {
+			for (int y = -1; y <= 1; y++) {
+				for (int z = -1; z <= 1; z++) {
+					auto cell = cells.find(QuantizedPoint{ q.x + x, q.y + y, q.z + z });
+
+					if (cell == cells.end()) {
+						continue;
+					}
+
+					for (int i = 0; i < cell->second.size(); i++) {
+						if (glm::distance(points[cell->second[i]], p) <= cellSize) {
+							return cell->second[i];
+						}
+					}
+				}
+			}
+		}
+
+		return -1;
+	}
+
+	void add(glm::vec3 p1, glm::vec3 p2, unsigned int id) {
+		edges[EdgeKey(weld(p1), weld(p2))].push_back(id);
+	}
+
+	// returns the ids along an edge or nullptr if nothing was added there
+	vector<unsigned int>* find(glm::vec3 p1, glm::vec3 p2) {
+		int a = findWeld(p1);
+		int b = findWeld(p2);
+
+		if (a == -1 || b == -1) {
+			return nullptr;
+		}
+
+		auto found = edges.find(EdgeKey(a, b));
+
+		if (found == edges.end()) {
+			return nullptr;
+		}
+
+		return &found->second;
+	}
+
+private:
+	// grid cell -> welded points in it
+	unordered_map<QuantizedPoint, vector<int>, QuantizedPointHash> cells;
+
+	// position of each welded point
+	vector<glm::vec3> points;
+};
+
+#endif
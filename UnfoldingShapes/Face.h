@@ -15,6 +15,7 @@
 #include <cmath>
 
 #include "Mesh.h"
+#include "EdgeIndex.h"
 
 inline float getTriangleArea(glm::vec3 a, glm::vec3 b, glm::vec3 c);
 inline glm::vec3 closestPointOnLine(glm::vec3 line, glm::vec3 pointOnLine, glm::vec3 target);
@@ -28,8 +29,8 @@ public:
 
 	struct Axis {
 		// smallest possible float
-		const float marginOfError = 0.0001;
-		const float sizeCap = 1000.0f;
+		static constexpr float marginOfError = 0.0001f;
+		static constexpr float sizeCap = 1000.0f;
 
 		// stores the axis with a point for refrence and the vector of the line
 		glm::vec3 originalPoint;
@@ -106,11 +107,29 @@ public:
 		}
 
 		float orientedAngle(glm::vec3 p1, glm::vec3 p2) {
-			p1 = glm::normalize(p1 - point);
-			p2 = glm::normalize(p2 - point);
+			// measure in the plane perpendicular to the axis so points that are not level with each other along the line still give the dihedral angle
+			p1 = p1 - point;
+			p2 = p2 - point;
+			p1 = p1 - line * glm::dot(p1, line);
+			p2 = p2 - line * glm::dot(p2, line);
+
+			// a point on the hinge line has no direction to measure from so there is nothing to fold
+			if (glm::length(p1) < marginOfError || glm::length(p2) < marginOfError) {
+				return 0.0f;
+			}
+
+			p1 = glm::normalize(p1);
+			p2 = glm::normalize(p2);
 
 			float result = glm::orientedAngle(p1, p2, line);
-			result = (result/(sqrt(result*result)))*3.1415926535 - result;
+
+			// a degenerate axis gives no angle to turn by
+			if (!std::isfinite(result)) {
+				return 0.0f;
+			}
+
+			// faces folded flat onto each other measure 0 and open by a half turn
+			result = copysign(3.1415926535f, result) - result;
 
 			// std::cout << "result: " << result << std::endl;
 
@@ -167,90 +186,55 @@ public:
 		initAxis();
 	}
 
+	// one axis per outside edge of the face
 	void initAxis() {
-		// find all vertices that only have two or less indices marked of them and then connect them within the triangle.
-		vector<unsigned int> validVertices;
+		// the model finds the outside edges of every face on import
+		vector<unsigned int> edges = mesh->boundaryEdges;
 
-		// identify vertices that are part of 1 or 2 triangles
-		for (int i = 0; i < mesh->vertices.size(); i++) {
-			int count = 0;
-			
-			for (int j = 0; j < mesh->indices.size(); j++) {
-				if (i == mesh->indices[j]) {
-					count++;
-				}
-			}
-
-			if (count != 0 && count <= 2) {
-				validVertices.push_back(i);
-			}
+		if (edges.empty()) {
+			edges = findBoundaryEdges();
 		}
 
-		// generate axis by matching indicies
-		// match two of the found vertices in the same triangle
-		for (int i = 0; i < validVertices.size(); i++) {
-			for (int j = 0; j < validVertices.size() && j != i; j++) {
-				for (int g = 0; g < mesh->indices.size(); g += 3) {
-					int verticesInTriangle = 0;
-
-					for (int h = g; h < g + 3; h++) {
-						if (validVertices[i] == mesh->indices[h] || validVertices[j] == mesh->indices[h]) {
-							verticesInTriangle++;
-						}
-					}
-
-					if (verticesInTriangle == 2) {
-						axis.push_back(new Axis(mesh->vertices[validVertices[i]].Position, mesh->vertices[validVertices[j]].Position));
-					}
-				}
+		axis.reserve(edges.size() / 2);
+
+		for (int i = 0; i + 1 < edges.size(); i += 2) {
+			glm::vec3 p1 = mesh->vertices[edges[i]].Position;
+			glm::vec3 p2 = mesh->vertices[edges[i + 1]].Position;
+
+			// a collapsed edge (like the ones at the poles of a uv sphere) has no line to fold about
+			if (glm::distance(p1, p2) <= Axis::marginOfError) {
+				continue;
 			}
+
+			axis.push_back(new Axis(p1, p2));
 		}
+	}
 
-		// delete both duplicates if found because this means that triangles were sharing an inside edge (we only want outside edges)
-		vector<unsigned int> toRemove;
+	// fallback for meshes that did not come with their outside edges
+	// an edge is on the outside when only one triangle of the face uses it (one hashed pass over the triangles)
+	vector<unsigned int> findBoundaryEdges() {
+		EdgeIndex edgeIndex;
+		edgeIndex.reserve(mesh->indices.size());
 
-		for (int i = 0; i < axis.size(); i++) {
-			//bool collision = false;
-
-			for (int j = 0; j < axis.size(); j++) {
-				if (*axis[i] == *axis[j] && i != j) {
-					toRemove.push_back(i);
-					//toRemove.push_back(j);
-					//collision = true;
-				}
-			}
+		for (unsigned int h = 0; h < mesh->indices.size(); h++) {
+			unsigned int next = h - h % 3 + (h + 1) % 3;
 
-			/*
-			if (collision) {
-				toRemove.push_back(i);
-			}
-			*/
+			edgeIndex.add(mesh->vertices[mesh->indices[h]].Position, mesh->vertices[mesh->indices[next]].Position, h);
 		}
 
-		// apply removal
-		// first sort all of them
-		for (unsigned int i = 0; i < toRemove.size(); i++) {
-			bool swapped = false;
-			for (unsigned int j = 0; j < toRemove.size() - 1 - i; j++) {
-				if (toRemove[j] > toRemove[j+1]) {
-					int temp = toRemove[j];
-					toRemove[j] = toRemove[j + 1];
-					toRemove[j + 1] = temp;
-
-					swapped = true;
-				}
-			}
+		vector<unsigned int> edges;
 
-			//exit search
-			if (swapped == false) {
-				break;
+		for (auto &edge : edgeIndex.edges) {
+			if (edge.second.size() == 1) {
+				unsigned int h = edge.second[0];
+				unsigned int next = h - h % 3 + (h + 1) % 3;
+
+				edges.push_back(mesh->indices[h]);
+				edges.push_back(mesh->indices[next]);
 			}
 		}
 
-		// finally remove from list
-		for (int i = toRemove.size() - 1; i >= 0; i--) {
-			axis.erase(axis.begin() + toRemove[i]);
-		}
+		return edges;
 	}
 
 	float getArea() {
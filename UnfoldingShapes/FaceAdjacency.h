@@ -0,0 +1,312 @@
+#ifndef FACEADJACENCY_H
+#define FACEADJACENCY_H
+
+#include <glm/glm.hpp>
+
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+
+#include "Face.h"
+#include "Graph.h"
+
+using namespace std;
+
+// spanning tree over the faces of a FaceAdjacency stored as flat arrays
+// it can also be a forest of seperate pieces: every root after the first one has no parent either and is followed in the
+// order by the faces of its own piece
+struct SpanningTree {
+	// face index of each face's parent (-1 for the root and for faces outside the tree)
+	vector<int> parent;
+
+	// adjacency edge going from the parent to each face (-1 for the root and for faces outside the tree)
+	vector<int> parentEdge;
+
+	// faces in the tree with every parent before its children (order[0] is the root)
+	vector<int> order;
+
+	// children of each face in compressed rows (filled by buildChildren)
+	vector<int> childOffsets;
+	vector<int> children;
+
+	// rest pose -> flat pose of the root of every piece after the first (filled by NetLayout::placePieces, empty for a tree)
+	vector<glm::mat4> pieceTransforms;
+
+	void reset(int faceCount) {
+		parent.assign(faceCount, -1);
+		parentEdge.assign(faceCount, -1);
+		order.clear();
+		childOffsets.clear();
+		children.clear();
+		pieceTransforms.clear();
+	}
+
+	int root() {
+		return order.empty() ? -1 : order[0];
+	}
+
+	// number of seperate pieces (1 for a tree)
+	int pieceCount() {
+		if (order.empty()) {
+			return 0;
+		}
+
+		int count = 1;
+		for (int i = 1; i < order.size(); i++) {
+			if (parent[order[i]] == -1) {
+				count++;
+			}
+		}
+
+		return count;
+	}
+
+	// fill the children rows from the parent list (children keep the tree order)
+	void buildChildren() {
+		childOffsets.assign(parent.size() + 1, 0);
+
+		int childCount = 0;
+		for (int i = 1; i < order.size(); i++) {
+			if (parent[order[i]] != -1) {
+				childOffsets[parent[order[i]] + 1]++;
+				childCount++;
+			}
+		}
+		for (int i = 0; i < parent.size(); i++) {
+			childOffsets[i + 1] += childOffsets[i];
+		}
+
+		children.assign(childCount, -1);
+
+		vector<int> cursor(childOffsets.begin(), childOffsets.end() - 1);
+		for (int i = 1; i < order.size(); i++) {
+			if (parent[order[i]] != -1) {
+				children[cursor[parent[order[i]]]++] = order[i];
+			}
+		}
+	}
+
+	// recompute the children and the order after parents were changed (faces not hanging from root are left out)
+	void rebuildFromParents(int root) {
+		vector<int> roots;
+		if (root != -1) {
+			roots.push_back(root);
+		}
+
+		rebuildFromParents(roots);
+	}
+
+	// same for a forest, the pieces are put in the order of roots
+	void rebuildFromParents(vector<int> &roots) {
+		childOffsets.assign(parent.size() + 1, 0);
+
+		for (int i = 0; i < parent.size(); i++) {
+			if (parent[i] != -1) {
+				childOffsets[parent[i] + 1]++;
+			}
+		}
+		for (int i = 0; i < parent.size(); i++) {
+			childOffsets[i + 1] += childOffsets[i];
+		}
+
+		children.assign(childOffsets.back(), -1);
+
+		vector<int> cursor(childOffsets.begin(), childOffsets.end() - 1);
+		for (int i = 0; i < parent.size(); i++) {
+			if (parent[i] != -1) {
+				children[cursor[parent[i]]++] = i;
+			}
+		}
+
+		order.clear();
+		for (int i = 0; i < roots.size(); i++) {
+			collectSubtree(roots[i], order);
+		}
+	}
+
+	// add face and everything below it to list
+	void collectSubtree(int face, vector<int> &list) {
+		int start = list.size();
+		list.push_back(face);
+
+		for (int i = start; i < list.size(); i++) {
+			for (int c = childOffsets[list[i]]; c < childOffsets[list[i] + 1]; c++) {
+				list.push_back(children[c]);
+			}
+		}
+	}
+};
+
+// immutable compressed sparse row copy of a faceMap
+// the neighbors of face i are neighbors[offsets[i]] to neighbors[offsets[i + 1] - 1] and all of them sit in contiguous arrays
+// so traversals walk memory in order instead of chasing node pointers around the heap
+class FaceAdjacency {
+public:
+	// face index -> face (same order as the shape's face list)
+	vector<Face*> faces;
+
+	// start of each face's edges (faceCount + 1 entries)
+	vector<int> offsets;
+
+	// face index on the other side of each edge
+	vector<int> neighbors;
+
+	// index into faces[i]->axis of the axis that hinges each edge
+	vector<int> axisIds;
+
+	// index of the base face
+	int root;
+
+	FaceAdjacency() {
+		root = -1;
+		offsets.push_back(0);
+	}
+
+	// build after the faceMap is populated and the axis are paired
+	FaceAdjacency(Graph<Face> &faceMap, vector<Face*> &faces) {
+		this->faces = faces;
+
+		faceIndex.reserve(faces.size());
+		for (int i = 0; i < faces.size(); i++) {
+			faceIndex[faces[i]] = i;
+		}
+
+		root = faceMap.rootNode != nullptr ? indexOf(faceMap.rootNode->data) : -1;
+
+		offsets.reserve(faces.size() + 1);
+		offsets.push_back(0);
+
+		for (int i = 0; i < faces.size(); i++) {
+			Graph<Face>::Node* node = faceMap.findNode(faces[i]);
+
+			if (node != nullptr) {
+				for (int j = 0; j < node->connections.size(); j++) {
+					Face* neighbor = node->connections[j]->data;
+
+					// find the axis shared with the neighbor
+					int axisId = -1;
+					for (int x = 0; x < faces[i]->axis.size(); x++) {
+						if (faces[i]->axis[x]->neighborFace == neighbor) {
+							axisId = x;
+							break;
+						}
+					}
+
+					neighbors.push_back(indexOf(neighbor));
+					axisIds.push_back(axisId);
+				}
+			}
+
+			offsets.push_back(neighbors.size());
+		}
+	}
+
+	int faceCount() {
+		return faces.size();
+	}
+
+	int edgeCount() {
+		return neighbors.size();
+	}
+
+	int degree(int face) {
+		return offsets[face + 1] - offsets[face];
+	}
+
+	// returns the index of a face (-1 if it is not part of the shape)
+	int indexOf(Face* face) {
+		auto found = faceIndex.find(face);
+
+		if (found == faceIndex.end()) {
+			return -1;
+		}
+
+		return found->second;
+	}
+
+	// the axis of face that hinges edge (nullptr if the pair was never matched)
+	Face::Axis* hinge(int face, int edge) {
+		if (axisIds[edge] == -1) {
+			return nullptr;
+		}
+
+		return faces[face]->axis[axisIds[edge]];
+	}
+
+	// true if the faces across edge share an axis to fold about
+	bool hinged(int edge) {
+		return axisIds[edge] != -1;
+	}
+
+	// returns the edge from face to neighbor (-1 if they do not touch)
+	int findEdge(int face, int neighbor) {
+		for (int e = offsets[face]; e < offsets[face + 1]; e++) {
+			if (neighbors[e] == neighbor) {
+				return e;
+			}
+		}
+
+		return -1;
+	}
+
+	// convert a solution graph (as made by Unfold) into a spanning tree over this adjacency
+	SpanningTree treeFromGraph(Graph<Face>* solution) {
+		SpanningTree tree;
+		tree.reset(faceCount());
+
+		if (solution == nullptr || solution->rootNode == nullptr) {
+			return tree;
+		}
+
+		vector<Graph<Face>::Node*> queue;
+
+		// the pieces of a forest one after another
+		for (int piece = -1; piece < (int)solution->pieceRoots.size(); piece++) {
+			Graph<Face>::Node* root = piece == -1 ? solution->rootNode : solution->pieceRoots[piece];
+
+			queue.push_back(root);
+			tree.order.push_back(indexOf(root->data));
+
+			for (int q = queue.size() - 1; q < queue.size(); q++) {
+				int current = tree.order[q];
+
+				for (int i = 0; i < queue[q]->connections.size(); i++) {
+					int child = indexOf(queue[q]->connections[i]->data);
+
+					tree.parent[child] = current;
+					tree.parentEdge[child] = findEdge(current, child);
+
+					queue.push_back(queue[q]->connections[i]);
+					tree.order.push_back(child);
+				}
+			}
+		}
+
+		return tree;
+	}
+
+	// convert a spanning tree into a solution graph that the rest of the program can animate
+	Graph<Face>* graphFromTree(SpanningTree &tree, Graph<Face>* solution) {
+		vector<Graph<Face>::Node*> nodes(faceCount(), nullptr);
+
+		nodes[tree.order[0]] = solution->newRootNode(faces[tree.order[0]]);
+
+		for (int i = 1; i < tree.order.size(); i++) {
+			int face = tree.order[i];
+
+			if (tree.parent[face] == -1) {
+				nodes[face] = solution->newPieceRoot(faces[face]);
+			}
+			else {
+				nodes[face] = solution->newNode(nodes[tree.parent[face]], faces[face]);
+			}
+		}
+
+		return solution;
+	}
+
+private:
+	unordered_map<Face*, int> faceIndex;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef FACETRANSFORMBUFFER_H
+#define FACETRANSFORMBUFFER_H
+
+#include <QtWidgets/qopenglwidget.h>
+#include <QtGui/qopenglfunctions_3_3_core.h>
+
+#include <glm/glm.hpp>
+
+#include "StreamBuffer.h"
+#include "RenderState.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// streams one mat4 per face to the gpu through a texture buffer (read with texelFetch on a samplerBuffer, 4 texels per matrix)
+// lets the vertex shader place every face of a shape while the vertices themselves never change
+class FaceTransformBuffer {
+public:
+	// bytes sent to the gpu since the buffer was made
+	size_t uploadedBytes = 0;
+
+	FaceTransformBuffer() {
+
+	}
+
+	FaceTransformBuffer(QOpenGLFunctions_3_3_Core **f) {
+		this->f = f;
+
+		(*f)->glGenBuffers(1, &buffer);
+		(*f)->glGenTextures(1, &texture);
+
+		(*f)->glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+		(*f)->glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+		capacity = sizeof(glm::mat4);
+
+		// each texel is one column of a matrix
+		(*f)->glBindTexture(GL_TEXTURE_BUFFER, texture);
+		(*f)->glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+
+		(*f)->glBindTexture(GL_TEXTURE_BUFFER, 0);
+		(*f)->glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	}
+
+	// replace the contents with transforms (glm matrices are column major so they can be copied as is)
+	void upload(vector<glm::mat4> &transforms) {
+		if (transforms.empty()) {
+			return;
+		}
+
+		size_t bytes = transforms.size() * sizeof(glm::mat4);
+
+		(*f)->glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+
+		if (bytes > capacity) {
+			(*f)->glBufferData(GL_TEXTURE_BUFFER, bytes, &transforms[0], GL_STREAM_DRAW);
+			capacity = bytes;
+		}
+		else {
+			// orphan the old storage so the driver does not wait for draws that still read it
+			(*f)->glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+			(*f)->glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, &transforms[0]);
+		}
+
+		(*f)->glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+		uploadedBytes += bytes;
+
+		UploadStats::bytes += bytes;
+		UploadStats::uploads++;
+	}
+
+	// bind to a texture unit for the shader's samplerBuffer
+	void bind(int unit) {
+		RenderState::bindTexture(*f, unit, GL_TEXTURE_BUFFER, texture);
+		RenderState::activeTexture(*f, 0);
+	}
+
+private:
+	QOpenGLFunctions_3_3_Core **f;
+
+	unsigned int buffer = 0;
+	unsigned int texture = 0;
+
+	// bytes allocated for the buffer
+	size_t capacity = 0;
+};
+
+#endif
@@ -8,6 +8,8 @@
 
 #include <iostream>
 #include <vector>
+#include <deque>
+#include <unordered_map>
 #include "Face.h"
 
 using namespace std;
@@ -23,6 +25,9 @@ public:
 
 	Node* rootNode = nullptr;
 
+	// roots of the other pieces when the graph is a forest (nothing connects to them)
+	std::vector<Node*> pieceRoots;
+
 	struct Node {
 		int id;
 		T* data;
@@ -32,58 +37,46 @@ public:
 		std::vector<Node*> connections;
 	};
 
-	// depth first search for node with data (recursive)
-	// enable searching means that there will be no overlap of the indexed nodes.
-	struct Node* findNode(Node* root, T* data, bool searching = false) {
-		static vector<Node*> searchedNodes;
+	// data -> node index maintained by newRootNode and newNode
+	// each graph owns its index so lookups are constant time and seperate graphs can be searched from different threads
+	unordered_map<T*, Node*> nodeIndex;
+
+	// returns the node holding data (nullptr if the data is not in the graph)
+	struct Node* findNode(T* data) {
+		auto found = nodeIndex.find(data);
 
-		// empty if starting a new search
-		if (searching == false) {
-			searchedNodes = vector<Node*>();
+		if (found == nodeIndex.end()) {
+			return nullptr;
 		}
 
-		if (root != nullptr) {
-			// first compare root and then children
-			if (root->data == data) {
-				return root;
-			}
+		return found->second;
+	}
 
-			for (int i = 0; i < root->connections.size(); i++) {
-				if (root->connections[i]->data == data) {
-					return root->connections[i];
-				}
+	struct Node* newRootNode(T* data) {
+		Node* node = allocateNode();
 
-				bool contains = false;
-				for (int j = 0; j < searchedNodes.size(); j++) {
-					if (searchedNodes[j] == root->connections[i]) {
-						contains = true;
-						break;
-					}
-				}
+		node->id = size++;
+		node->data = data;
 
-				if (contains == false) {
-					searchedNodes.push_back(root->connections[i]);
+		node->graph = this;
 
-					Node* attempt = findNode(root->connections[i], data, true);
-					if (attempt != nullptr) {
-						return attempt;
-					}
-				}
-			}
-		}
+		rootNode = node;
+		nodeIndex[data] = node;
 
-		return nullptr;
+		return node;
 	}
 
-	struct Node* newRootNode(T* data) {
-		Node* node = new Node();
+	// start another piece of a forest (rootNode stays the first piece)
+	struct Node* newPieceRoot(T* data) {
+		Node* node = allocateNode();
 
 		node->id = size++;
 		node->data = data;
 
 		node->graph = this;
 
-		rootNode = node;
+		pieceRoots.push_back(node);
+		nodeIndex[data] = node;
 
 		return node;
 	}
@@ -91,16 +84,18 @@ public:
 	// makes a new node (specify the parent and then the data) (automatically adds connection to root as parent)
 	struct Node* newNode(Node* root, T* data, bool twoWayConnections = false) {
 		// create node if root is valid
-		Node* node = findNode(rootNode, data);
+		Node* node = findNode(data);
 
 		if (node == nullptr) {
-			node = new Node();
+			node = allocateNode();
 
 			node->id = size++;
 			node->data = data;
 
 			node->graph = this;
 
+			nodeIndex[data] = node;
+
 			// connect parent and child
 			root->connections.push_back(node);
 
@@ -144,6 +139,16 @@ public:
 		return node;
 	}
 
+	// drop every node so the graph can be filled again
+	// the nodes stay in the pool (with their connection buffers) and are handed out again by the next newNode calls
+	void reset() {
+		size = 0;
+		rootNode = nullptr;
+
+		pieceRoots.clear();
+		nodeIndex.clear();
+	}
+
 	// You must initialize with the first Node data
 	Graph() {
 		size = 0;
@@ -154,6 +159,27 @@ public:
 		size = 0;
 		rootNode = newRootNode(data);
 	}
+
+	// nodes point at each other and back at the graph so a graph can not be copied
+	Graph(const Graph&) = delete;
+	Graph& operator=(const Graph&) = delete;
+
+private:
+	// every node of the graph lives here (a deque never moves its elements so node pointers stay valid as it grows)
+	// the pool is freed with the graph so no node has to be deleted by hand
+	deque<Node> pool;
+
+	// take the next free node in the pool (nodes past size are left over from before the last reset)
+	Node* allocateNode() {
+		if (size == pool.size()) {
+			pool.emplace_back();
+		}
+
+		Node* node = &pool[size];
+		node->connections.clear();
+
+		return node;
+	}
 };
 
 #endif
\ No newline at end of file
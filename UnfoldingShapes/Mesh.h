@@ -11,6 +11,10 @@
 
 #include <shader.h>
 
+#include "StreamBuffer.h"
+#include "RenderStats.h"
+#include "RenderState.h"
+
 #include <string>
 #include <vector>
 using namespace std;
@@ -77,9 +81,18 @@ public:
 	//number of samples for multisampling
 	int samples;
 
+	//index of the mesh's transform for the hinged shader (-1 until setFaceId)
+	int faceId = -1;
+
+	//true once a MeshBatch holds the geometry, the mesh then has no buffers of its own and is only kept for its data
+	bool batched = false;
+
 	// backup data
 	vector<Vertex> backupVertices;
 
+	// outside edges of the face as pairs of indices into vertices (filled by the model on import)
+	vector<unsigned int> boundaryEdges;
+
 	Mesh(QOpenGLFunctions_3_3_Core **f, vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures, vector<Material> materials, int samples)
 	{
 		this->f = f;
@@ -99,7 +112,24 @@ public:
 	//render the mesh
 	void Draw(Shader &shader)
 	{
-		shader.use();
+		RenderState::use(*f, shader);
+
+		setMaterial(shader);
+
+		//draw mesh
+		render();
+
+		//reset back to default settings
+		RenderState::activeTexture(*f, 0);
+	}
+
+	//bind the textures and set the material uniforms of the mesh (shader must be in use)
+	//skipped if this mesh was the last to set them on the shader
+	void setMaterial(Shader &shader)
+	{
+		if (!RenderState::changeMaterial(this)) {
+			return;
+		}
 
 		//default
 		shader.setBool("hasDiffuseTex", false);
@@ -115,7 +145,6 @@ public:
 			unsigned int heightNr = 1;
 			for (int i = 0; i < textures.size(); i++)
 			{
-				(*f)->glActiveTexture(GL_TEXTURE0 + i); //active texture unit before binding
 				//retrieve texture number (the N in diffuse_textureN)
 				string number;
 				string name = textures[i].type;
@@ -143,10 +172,10 @@ public:
 				//finally bind the texture
 				//multisampling
 				if (samples > 1) {
-					(*f)->glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, textures[i].id);
+					RenderState::bindTexture(*f, i, GL_TEXTURE_2D_MULTISAMPLE, textures[i].id);
 				}
 				else {
-					(*f)->glBindTexture(GL_TEXTURE_2D, textures[i].id);
+					RenderState::bindTexture(*f, i, GL_TEXTURE_2D, textures[i].id);
 				}
 			}
 		}
@@ -169,24 +198,94 @@ public:
 			//shader.setVec3("specular_color", glm::vec3(1.0f));
 			//shader.setVec3("ambient_color", glm::vec3(1.0f));
 		}
+	}
 
-		//draw mesh
-		render();
+	//returns true if the mesh is drawn with the same textures and materials as other
+	bool sameMaterial(Mesh &other)
+	{
+		if (textures.size() != other.textures.size() || materials.size() != other.materials.size()) {
+			return false;
+		}
 
-		//reset back to default settings
-		(*f)->glActiveTexture(GL_TEXTURE0);
+		for (int i = 0; i < textures.size(); i++) {
+			if (textures[i].id != other.textures[i].id || textures[i].type != other.textures[i].type) {
+				return false;
+			}
+		}
+
+		for (int i = 0; i < materials.size(); i++) {
+			Material &a = materials[i];
+			Material &b = other.materials[i];
+
+			if (a.diffuse != b.diffuse || a.specular != b.specular || a.ambient != b.ambient || a.shine != b.shine || a.specularStrength != b.specularStrength || a.opacity != b.opacity) {
+				return false;
+			}
+		}
+
+		return true;
 	}
 
+	//the vao is left bound so the next draw of the same mesh does not have to bind it again
 	void render() {
-		(*f)->glBindVertexArray(VAO);
+		if (batched) {
+			return;
+		}
+
+		RenderState::bindVertexArray(*f, VAO);
 		(*f)->glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-		(*f)->glBindVertexArray(0);
+
+		RenderStats::drawCalls++;
+	}
+
+	// give every vertex the face id as vertex attribute 5 (a small buffer uploaded once)
+	void setFaceId(int id) {
+		if (batched) {
+			return;
+		}
+
+		if (faceId == -1) {
+			(*f)->glGenBuffers(1, &faceIdVBO);
+		}
+		faceId = id;
+
+		vector<int> ids(vertices.size(), id);
+
+		RenderState::bindVertexArray(*f, VAO);
+		(*f)->glBindBuffer(GL_ARRAY_BUFFER, faceIdVBO);
+		(*f)->glBufferData(GL_ARRAY_BUFFER, ids.size() * sizeof(int), &ids[0], GL_STATIC_DRAW);
+
+		//vertex face id
+		(*f)->glEnableVertexAttribArray(5);
+		(*f)->glVertexAttribIPointer(5, 1, GL_INT, sizeof(int), (void*)0);
+
+		RenderState::bindVertexArray(*f, 0);
+	}
+
+	//free the vao, vertex stream and index buffer once a MeshBatch draws this mesh (they are never used again)
+	void releaseBuffers() {
+		if (batched) {
+			return;
+		}
+
+		clearBuffers();
+
+		if (faceId != -1) {
+			(*f)->glDeleteBuffers(1, &faceIdVBO);
+			faceIdVBO = 0;
+			faceId = -1;
+		}
+
+		batched = true;
 	}
 
 	// reset the mesh and also recalculate the normals
 	void rebuild() {
 		recompileNormals();
 
+		if (batched) {
+			return;
+		}
+
 		//clearBuffers();
 
 		//setupMesh();
@@ -218,16 +317,33 @@ public:
 		return normalSum * (1.0f / (indices.size() / 3));
 	}
 
+	// one flat normal for the whole face
+	void recompileNormals() {
+		glm::vec3 newNormal = getNormal();
+
+		for (int i = 0; i < indices.size(); i+=3) {
+			vertices[indices[i]].Normal = newNormal;
+			vertices[indices[i+1]].Normal = newNormal;
+			vertices[indices[i+2]].Normal = newNormal;
+		}
+	}
+
 private:
 	QOpenGLFunctions_3_3_Core **f;
 
 	//render data 
-	unsigned int VBO, EBO;
+	unsigned int EBO;
+
+	//vertices change every frame while unfolding so they are streamed, the indices never change and are uploaded once
+	StreamBuffer vertexStream;
+
+	unsigned int faceIdVBO = 0;
 
 	void clearBuffers() {
-		// clear data to preserve memory
+		// clear data to preserve memory (unbound first so the id is not cached as bound after it is reused)
+		RenderState::bindVertexArray(*f, 0);
 		(*f)->glDeleteVertexArrays(1, &VAO);
-		(*f)->glDeleteBuffers(1, &VBO);
+		vertexStream.destroy();
 		(*f)->glDeleteBuffers(1, &EBO);
 	}
 
@@ -236,54 +352,49 @@ private:
 	{
 		//create buffers/arrays
 		(*f)->glGenVertexArrays(1, &VAO);
-		(*f)->glGenBuffers(1, &VBO);
 		(*f)->glGenBuffers(1, &EBO);
+		vertexStream = StreamBuffer(f, GL_ARRAY_BUFFER);
+
+		RenderState::bindVertexArray(*f, VAO);
+
+		//the element buffer binding is part of the vao so it only has to be set here
+		(*f)->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		(*f)->glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+
+		RenderState::bindVertexArray(*f, 0);
 
 		rebuildMesh();
 	}
 
 	void rebuildMesh() {
-		(*f)->glBindVertexArray(VAO);
-		// load data into vertex buffers
-		(*f)->glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
 		//Tip from learnopengl.com
 		//A great thing about structs is that their memory layout is sequential for all its items.
 		//The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
 		//again translates to 3/2 floats which translates to a byte array.
-		(*f)->glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+		size_t offset = vertexStream.upload(&vertices[0], vertices.size() * sizeof(Vertex));
 
-		(*f)->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-		(*f)->glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+		//point the attributes at the region that was just written
+		RenderState::bindVertexArray(*f, VAO);
+		(*f)->glBindBuffer(GL_ARRAY_BUFFER, vertexStream.id());
 
 		//set the vertex attribute pointers
 		//vertex Positions
 		(*f)->glEnableVertexAttribArray(0);
-		(*f)->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+		(*f)->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offset));
 		//vertex normals
 		(*f)->glEnableVertexAttribArray(1);
-		(*f)->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+		(*f)->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offset + offsetof(Vertex, Normal)));
 		//vertex texture coords
 		(*f)->glEnableVertexAttribArray(2);
-		(*f)->glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+		(*f)->glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offset + offsetof(Vertex, TexCoords)));
 		//vertex tangent
 		(*f)->glEnableVertexAttribArray(3);
-		(*f)->glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
+		(*f)->glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offset + offsetof(Vertex, Tangent)));
 		//vertex bitangent
 		(*f)->glEnableVertexAttribArray(4);
-		(*f)->glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
+		(*f)->glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offset + offsetof(Vertex, Bitangent)));
 
-		(*f)->glBindVertexArray(0);
-	}
-
-	void recompileNormals() {
-		glm::vec3 newNormal = getNormal();
-
-		for (int i = 0; i < indices.size(); i+=3) {
-			vertices[indices[i]].Normal = newNormal;
-			vertices[indices[i+1]].Normal = newNormal;
-			vertices[indices[i+2]].Normal = newNormal;
-		}
+		RenderState::bindVertexArray(*f, 0);
 	}
 
 	void printVertices() {
@@ -0,0 +1,190 @@
+#ifndef MESHBATCH_H
+#define MESHBATCH_H
+
+#include <QtWidgets/qopenglwidget.h>
+#include <QtGui/qopenglfunctions_3_3_core.h>
+
+#include <glm/glm.hpp>
+
+#include <shader.h>
+
+#include <iostream>
+#include <vector>
+
+#include "Mesh.h"
+#include "StreamBuffer.h"
+#include "RenderStats.h"
+#include "RenderState.h"
+
+using namespace std;
+
+// every mesh of a model packed into one vertex and index buffer so the whole model is drawn with one call
+// (one call per run of meshes that share textures and materials, for most shapes that is the whole model)
+// the meshes keep their own data, the batch copies their vertices in when they change
+class MeshBatch {
+public:
+	// where each mesh sits in the batch (mesh i is ranges[i])
+	struct Range {
+		unsigned int firstVertex;
+		unsigned int vertexCount;
+
+		unsigned int firstIndex;
+		unsigned int indexCount;
+	};
+
+	// consecutive meshes drawn together with the material of the first one
+	struct Run {
+		int firstMesh;
+
+		unsigned int firstIndex;
+		unsigned int indexCount;
+	};
+
+	vector<Range> ranges;
+	vector<Run> runs;
+
+	vector<Vertex> vertices;
+	vector<unsigned int> indices;
+
+	unsigned int VAO;
+
+	MeshBatch() {
+
+	}
+
+	MeshBatch(QOpenGLFunctions_3_3_Core **f, vector<Mesh> &meshes) {
+		this->f = f;
+
+		ranges.resize(meshes.size());
+
+		unsigned int vertexCount = 0;
+		unsigned int indexCount = 0;
+		for (int i = 0; i < meshes.size(); i++) {
+			vertexCount += meshes[i].vertices.size();
+			indexCount += meshes[i].indices.size();
+		}
+
+		vertices.reserve(vertexCount);
+		indices.reserve(indexCount);
+
+		// the face id of every vertex is its mesh so the hinged shader can find the transform of the face
+		vector<int> faceIds;
+		faceIds.reserve(vertexCount);
+
+		for (int i = 0; i < meshes.size(); i++) {
+			Range range;
+			range.firstVertex = vertices.size();
+			range.vertexCount = meshes[i].vertices.size();
+			range.firstIndex = indices.size();
+			range.indexCount = meshes[i].indices.size();
+
+			ranges[i] = range;
+
+			vertices.insert(vertices.end(), meshes[i].vertices.begin(), meshes[i].vertices.end());
+			faceIds.insert(faceIds.end(), range.vertexCount, i);
+
+			for (int j = 0; j < meshes[i].indices.size(); j++) {
+				indices.push_back(range.firstVertex + meshes[i].indices[j]);
+			}
+
+			// start a new run when the look changes
+			if (runs.empty() || !meshes[runs.back().firstMesh].sameMaterial(meshes[i])) {
+				Run run;
+				run.firstMesh = i;
+				run.firstIndex = range.firstIndex;
+				run.indexCount = 0;
+
+				runs.push_back(run);
+			}
+			runs.back().indexCount += range.indexCount;
+		}
+
+		(*f)->glGenVertexArrays(1, &VAO);
+		(*f)->glGenBuffers(1, &EBO);
+		(*f)->glGenBuffers(1, &faceIdVBO);
+		vertexStream = StreamBuffer(f, GL_ARRAY_BUFFER);
+
+		RenderState::bindVertexArray(*f, VAO);
+
+		// indices and face ids never change
+		(*f)->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		(*f)->glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+
+		(*f)->glBindBuffer(GL_ARRAY_BUFFER, faceIdVBO);
+		(*f)->glBufferData(GL_ARRAY_BUFFER, faceIds.size() * sizeof(int), &faceIds[0], GL_STATIC_DRAW);
+
+		//vertex face id
+		(*f)->glEnableVertexAttribArray(5);
+		(*f)->glVertexAttribIPointer(5, 1, GL_INT, sizeof(int), (void*)0);
+
+		RenderState::bindVertexArray(*f, 0);
+
+		upload();
+	}
+
+	// copy the current vertices of the meshes in and send them to the gpu
+	void update(vector<Mesh> &meshes) {
+		for (int i = 0; i < meshes.size() && i < ranges.size(); i++) {
+			std::copy(meshes[i].vertices.begin(), meshes[i].vertices.end(), vertices.begin() + ranges[i].firstVertex);
+		}
+
+		upload();
+	}
+
+	// draw all the meshes (material settings come from the first mesh of each run)
+	void Draw(Shader &shader, vector<Mesh> &meshes) {
+		RenderState::use(*f, shader);
+		RenderState::bindVertexArray(*f, VAO);
+
+		for (int i = 0; i < runs.size(); i++) {
+			meshes[runs[i].firstMesh].setMaterial(shader);
+
+			(*f)->glDrawElements(GL_TRIANGLES, runs[i].indexCount, GL_UNSIGNED_INT, (void*)(runs[i].firstIndex * sizeof(unsigned int)));
+
+			RenderStats::drawCalls++;
+		}
+
+		//reset back to default settings (the vao stays bound for the next draw of the batch)
+		RenderState::activeTexture(*f, 0);
+	}
+
+private:
+	QOpenGLFunctions_3_3_Core **f;
+
+	unsigned int EBO;
+	unsigned int faceIdVBO;
+
+	StreamBuffer vertexStream;
+
+	void upload() {
+		if (vertices.empty()) {
+			return;
+		}
+
+		size_t offset = vertexStream.upload(&vertices[0], vertices.size() * sizeof(Vertex));
+
+		//point the attributes at the region that was just written
+		RenderState::bindVertexArray(*f, VAO);
+		(*f)->glBindBuffer(GL_ARRAY_BUFFER, vertexStream.id());
+
+		//vertex Positions
+		(*f)->glEnableVertexAttribArray(0);
+		(*f)->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offset));
+		//vertex normals
+		(*f)->glEnableVertexAttribArray(1);
+		(*f)->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offset + offsetof(Vertex, Normal)));
+		//vertex texture coords
+		(*f)->glEnableVertexAttribArray(2);
+		(*f)->glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offset + offsetof(Vertex, TexCoords)));
+		//vertex tangent
+		(*f)->glEnableVertexAttribArray(3);
+		(*f)->glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offset + offsetof(Vertex, Tangent)));
+		//vertex bitangent
+		(*f)->glEnableVertexAttribArray(4);
+		(*f)->glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offset + offsetof(Vertex, Bitangent)));
+
+		RenderState::bindVertexArray(*f, 0);
+	}
+};
+
+#endif
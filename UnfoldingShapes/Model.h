@@ -20,7 +20,10 @@
 #include <shader.h>
 
 #include "Mesh.h"
+#include "MeshBatch.h"
 #include "Camera.h"
+#include "EdgeIndex.h"
+#include "DisjointSet.h"
 
 #include <vector>
 #include <map>
@@ -28,9 +31,6 @@
 
 inline unsigned int TextureFromFile(QOpenGLFunctions_3_3_Core **f, const char *path, const string &directory, int samples = 1, bool gamma = false);
 
-// prototypes
-bool tangantFace(vector<Vertex> vertices1, vector<Vertex> vertices2);
-
 //Do not reinitialize the model
 class Model {
 public:
@@ -44,6 +44,9 @@ public:
 	//multisampling
 	int samples;
 
+	//all meshes in one buffer (nullptr to draw each mesh on its own)
+	MeshBatch* batch = nullptr;
+
 	//expects file path to 3d model with multisampling
 	Model(QOpenGLFunctions_3_3_Core **f, string const &path, int samples, bool gamma = false) : gammaCorrection(gamma)
 	{
@@ -67,13 +70,36 @@ public:
 
 	//draws the model and all meshes with it according to the shader
 	void Draw(Shader &shader, Camera &camera) {
+		if (batch != nullptr) {
+			batch->Draw(shader, meshes);
+			return;
+		}
+
 		for (unsigned int i = 0; i < meshes.size(); i++) {
 			meshes[i].Draw(shader);
 		}
 	}
 
+	//pack the meshes into one buffer so the model draws with one call per material instead of one per mesh
+	void enableBatching() {
+		if (batch == nullptr && meshes.size() > 0) {
+			batch = new MeshBatch(f, meshes);
+
+			//the batch has its own copy of the geometry so the buffers of each mesh would only take up memory
+			for (unsigned int i = 0; i < meshes.size(); i++) {
+				meshes[i].releaseBuffers();
+			}
+		}
+	}
+
 	//sort the meshes before drawing based on camera position (furthest first)
 	void DrawSorted(Shader &shader, Camera &camera) {
+		//a batched model has no per mesh buffers left to draw from
+		if (batch != nullptr) {
+			batch->Draw(shader, meshes);
+			return;
+		}
+
 		vector<int> sorted = vector<int>();
 		for (unsigned int i = 0; i < meshes.size(); i++) {
 			sorted.push_back(i);
@@ -108,6 +134,16 @@ public:
 	}
 
 	void rebuildMeshes() {
+		if (batch != nullptr) {
+			//the normals are still worked out per mesh but everything is sent in one upload
+			for (int i = 0; i < meshes.size(); i++) {
+				meshes[i].recompileNormals();
+			}
+
+			batch->update(meshes);
+			return;
+		}
+
 		for (int i = 0; i < meshes.size(); i++) {
 			meshes[i].rebuild();
 		}
@@ -305,137 +341,56 @@ private:
 		}
 
 		// consolidate indicies to decide faces
-		vector<vector<unsigned int>> consolidatedIndices;
-
-		// populate the temp list
-		for (int i = 0; i < indices.size(); i+=3) {
-			consolidatedIndices.push_back(vector<unsigned int>());
-			consolidatedIndices[consolidatedIndices.size() - 1].push_back(indices[i]);
-			consolidatedIndices[consolidatedIndices.size() - 1].push_back(indices[i + 1]);
-			consolidatedIndices[consolidatedIndices.size() - 1].push_back(indices[i + 2]);
-		}
-
-		// if two faces are tangent then combine them
-		for (int i = 0; i < consolidatedIndices.size(); i++) {
-			vector<int> toRemove;
-			for (int j = i+1; j < consolidatedIndices.size(); j++) {
-				vector<Vertex> vertices1;
-				vector<Vertex> vertices2;
-
-				vertices1.push_back(vertices[consolidatedIndices[i][0]]);
-				vertices1.push_back(vertices[consolidatedIndices[i][1]]);
-				vertices1.push_back(vertices[consolidatedIndices[i][2]]);
-
-				vertices2.push_back(vertices[consolidatedIndices[j][0]]);
-				vertices2.push_back(vertices[consolidatedIndices[j][1]]);
-				vertices2.push_back(vertices[consolidatedIndices[j][2]]);
-
-				// if the two faces are tangant, then add j to i and remove j.
-				if (tangantFace(vertices1, vertices2)) {
-					toRemove.push_back(j);
-
-					consolidatedIndices[i].push_back(consolidatedIndices[j][0]);
-					consolidatedIndices[i].push_back(consolidatedIndices[j][1]);
-					consolidatedIndices[i].push_back(consolidatedIndices[j][2]);
-				}
-			}
-
-			// erase consolidated scrap
-			for (int j = toRemove.size() - 1; j >= 0; j--) {
-				consolidatedIndices.erase(consolidatedIndices.begin() + toRemove[j]);
-			}
-		}
+		// triangles that share an edge and lie on the same plane are joined into one face
+		// the outside edges of each face are found at the same time (pairs of vertex indices)
+		vector<vector<unsigned int>> boundaryEdges;
+		vector<vector<unsigned int>> consolidatedIndices = clusterFaces(vertices, indices, boundaryEdges);
 
 		// std::cout << "init packing" << std::endl;
 
 		// pack output meshes with the proper vertices and indicies based on face
 		vector<Mesh> output;
+		output.reserve(consolidatedIndices.size());
+
+		// scratch buffers reused by every face
+		// remap holds the local index of each model vertex for the current face (-1 if the face does not use it)
+		vector<int> remap(vertices.size(), -1);
+		vector<unsigned int> usedVertices;
+		vector<Vertex> consolidatedVertices;
+		vector<unsigned int> repairedIndices;
 
 		for (int i = 0; i < consolidatedIndices.size(); i++) {
 			// std::cout << "Packing face: " << i + 1 << " of " << consolidatedIndices.size() << std::endl;
 
-			vector<Vertex> consolidatedVertices;
-			vector<unsigned int> compressedIndices = consolidatedIndices[i];
+			usedVertices.clear();
+			consolidatedVertices.clear();
+			repairedIndices.clear();
 
-			/*
-			std::cout << "indices 1 (" << compressedIndices.size() << "): ";
-			for (int x = 0; x < compressedIndices.size(); x++) {
-				std::cout << compressedIndices[x] << ", ";
-			}
-			std::cout << std::endl;
-			*/
-
-			// sort indicies (bubble sort)
-			for (int j = 0; j < compressedIndices.size(); j++) {
-				for (int g = 0; g < compressedIndices.size() - j - 1; g++) {
-					if (compressedIndices[g] > compressedIndices[g+1]) {
-						unsigned int temp = compressedIndices[g + 1];
-						compressedIndices[g + 1] = compressedIndices[g];
-						compressedIndices[g] = temp;
-					}
-				}
-			}
+			// single pass: copy each vertex the first time it is used and translate the indices to the compressed list
+			for (int j = 0; j < consolidatedIndices[i].size(); j++) {
+				unsigned int index = consolidatedIndices[i][j];
 
-			/*
-			std::cout << "indices 2 (" << compressedIndices.size() << "): ";
-			for (int x = 0; x < compressedIndices.size(); x++) {
-				std::cout << compressedIndices[x] << ", ";
-			}
-			std::cout << std::endl;
-			*/
+				if (remap[index] == -1) {
+					remap[index] = consolidatedVertices.size();
 
-			// remove duplicates
-			for (int j = compressedIndices.size() - 2; j >= 0; j--) {
-				if (compressedIndices[j] == compressedIndices[j + 1]) {
-					compressedIndices.erase(compressedIndices.begin() + j + 1);
+					consolidatedVertices.push_back(vertices[index]);
+					usedVertices.push_back(index);
 				}
-			}
 
-			/*
-			std::cout << "indices 3 (" << compressedIndices.size() << "): ";
-			for (int x = 0; x < compressedIndices.size(); x++) {
-				std::cout << compressedIndices[x] << ", ";
+				repairedIndices.push_back(remap[index]);
 			}
-			std::cout << std::endl;
-			*/
 
-			// populate vertices
-			for (int j = 0; j < compressedIndices.size(); j++) {
-				consolidatedVertices.push_back(vertices[compressedIndices[j]]);
-			}
-
-			// repair indice list (match compressed to uncompressed)
-			vector<unsigned int> repairedIndices = consolidatedIndices[i];
-			for (int j = 0; j < consolidatedIndices[i].size(); j++) {
-				for (int g = 0; g < compressedIndices.size(); g++) {
-					if (compressedIndices[g] == repairedIndices[j]) {
-						repairedIndices[j] = g;
-					}
-				}
-			}
-
-			/*
-			std::cout << "vertices(" << consolidatedVertices.size() << "): ";
-			for (int x = 0; x < consolidatedVertices.size(); x++) {
-				std::cout << consolidatedVertices[x].Position.x << "," << consolidatedVertices[x].Position.y << "," << consolidatedVertices[x].Position.z << " ";
-			}
-			std::cout << std::endl;
+			output.push_back(Mesh(f, consolidatedVertices, repairedIndices, textures, materials, samples));
 
-			std::cout << "indices condensed(" << consolidatedIndices[i].size() << "): ";
-			for (int x = 0; x < consolidatedIndices[i].size(); x++) {
-				std::cout << consolidatedIndices[i][x] << ", ";
+			// the outside edges only use vertices of this face so they go through the same table
+			for (int j = 0; j < boundaryEdges[i].size(); j++) {
+				output.back().boundaryEdges.push_back(remap[boundaryEdges[i][j]]);
 			}
-			std::cout << std::endl;
 
-			std::cout << "indices(" << repairedIndices.size() << "): ";
-			for (int x = 0; x < repairedIndices.size(); x++) {
-				std::cout << repairedIndices[x] << ", ";
+			// clear only the entries this face touched so the table is ready for the next face
+			for (int j = 0; j < usedVertices.size(); j++) {
+				remap[usedVertices[j]] = -1;
 			}
-			std::cout << std::endl;
-			std::cout << std::endl;
-			*/
-
-			output.push_back(Mesh(f, consolidatedVertices, repairedIndices, textures, materials, samples));
 		}
 
 		std::cout << "finished packing " << output.size() << " faces" << std::endl;
@@ -491,31 +446,112 @@ private:
 		return "";
 	}
 
-	glm::vec4 getPlane(vector<Vertex> vert) {
-		float a1 = vert[1].Position.x - vert[0].Position.x;
-		float b1 = vert[1].Position.y - vert[0].Position.y;
-		float c1 = vert[1].Position.z - vert[0].Position.z;
-		float a2 = vert[2].Position.x - vert[0].Position.x;
-		float b2 = vert[2].Position.y - vert[0].Position.y;
-		float c2 = vert[2].Position.z - vert[0].Position.z;
+	// group the triangles into planar faces
+	// every edge is hashed once so only triangles that share an edge are compared and joined (near-linear instead of comparing every pair)
+	// faces are returned in order of their first triangle with the triangle indices in their original order
+	// boundaryEdges is filled with the outside edges of each face as pairs of vertex indices
+	vector<vector<unsigned int>> clusterFaces(vector<Vertex> &vertices, vector<unsigned int> &indices, vector<vector<unsigned int>> &boundaryEdges) {
+		unsigned int triangleCount = indices.size() / 3;
+
+		// plane of each triangle
+		vector<glm::vec4> planes(triangleCount);
+		for (unsigned int i = 0; i < triangleCount; i++) {
+			planes[i] = glm::normalize(getPlane(vertices[indices[i * 3]].Position, vertices[indices[i * 3 + 1]].Position, vertices[indices[i * 3 + 2]].Position));
+		}
+
+		// edge -> half edges (keyed by position since neighboring triangles do not always share vertex indices)
+		// half edge h goes from indices[h] to the next corner of triangle h / 3
+		EdgeIndex edgeIndex;
+		edgeIndex.reserve(indices.size());
+
+		for (unsigned int h = 0; h < triangleCount * 3; h++) {
+			edgeIndex.add(vertices[indices[h]].Position, vertices[indices[nextHalfEdge(h)]].Position, h);
+		}
+
+		// join the tangent triangles around each edge
+		DisjointSet faceSets(triangleCount);
+
+		for (auto &edge : edgeIndex.edges) {
+			vector<unsigned int> &halfEdges = edge.second;
+
+			for (unsigned int i = 0; i < halfEdges.size(); i++) {
+				for (unsigned int j = i + 1; j < halfEdges.size(); j++) {
+					if (tangantPlanes(planes[halfEdges[i] / 3], planes[halfEdges[j] / 3])) {
+						faceSets.join(halfEdges[i] / 3, halfEdges[j] / 3);
+					}
+				}
+			}
+		}
+
+		// collect the triangles of each set
+		vector<vector<unsigned int>> consolidatedIndices;
+		vector<int> faceOfSet(triangleCount, -1);
+
+		for (unsigned int i = 0; i < triangleCount; i++) {
+			unsigned int set = faceSets.find(i);
+
+			if (faceOfSet[set] == -1) {
+				faceOfSet[set] = consolidatedIndices.size();
+				consolidatedIndices.push_back(vector<unsigned int>());
+			}
+
+			vector<unsigned int> &face = consolidatedIndices[faceOfSet[set]];
+			face.push_back(indices[i * 3]);
+			face.push_back(indices[i * 3 + 1]);
+			face.push_back(indices[i * 3 + 2]);
+		}
+
+		// an edge is on the outside of a face when no other triangle of the same face uses it
+		boundaryEdges = vector<vector<unsigned int>>(consolidatedIndices.size());
+
+		for (auto &edge : edgeIndex.edges) {
+			vector<unsigned int> &halfEdges = edge.second;
+
+			for (unsigned int i = 0; i < halfEdges.size(); i++) {
+				unsigned int set = faceSets.find(halfEdges[i] / 3);
+
+				bool inside = false;
+				for (unsigned int j = 0; j < halfEdges.size(); j++) {
+					if (i != j && faceSets.find(halfEdges[j] / 3) == set) {
+						inside = true;
+						break;
+					}
+				}
+
+				if (!inside) {
+					boundaryEdges[faceOfSet[set]].push_back(indices[halfEdges[i]]);
+					boundaryEdges[faceOfSet[set]].push_back(indices[nextHalfEdge(halfEdges[i])]);
+				}
+			}
+		}
+
+		return consolidatedIndices;
+	}
+
+	// the half edge that follows h around its triangle
+	unsigned int nextHalfEdge(unsigned int h) {
+		return h - h % 3 + (h + 1) % 3;
+	}
+
+	glm::vec4 getPlane(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2) {
+		float a1 = p1.x - p0.x;
+		float b1 = p1.y - p0.y;
+		float c1 = p1.z - p0.z;
+		float a2 = p2.x - p0.x;
+		float b2 = p2.y - p0.y;
+		float c2 = p2.z - p0.z;
 		float a = b1 * c2 - b2 * c1;
 		float b = a2 * c1 - a1 * c2;
 		float c = a1 * b2 - b1 * a2;
-		float d = (-a * vert[0].Position.x - b * vert[0].Position.y - c * vert[0].Position.z);
+		float d = (-a * p0.x - b * p0.y - c * p0.z);
 
 		return glm::vec4(a, b, c, d);
 	}
 
-	bool tangantFace(vector<Vertex> vertices1, vector<Vertex> vertices2) {
-		glm::vec4 plane1 = getPlane(vertices1);
-		glm::vec4 plane2 = getPlane(vertices2);
-
-		plane1 = glm::vec4(glm::normalize(plane1));
-		plane2 = glm::vec4(glm::normalize(plane2));
-
+	// both planes must already be normalized
+	bool tangantPlanes(glm::vec4 plane1, glm::vec4 plane2) {
 		//std::cout << glm::distance(plane1, plane2) << std::endl;
 		if (glm::distance(plane1, plane2) <= 0.0001f) {
-			//std::cout << "here" << std::endl;
 			return true;
 		}
 
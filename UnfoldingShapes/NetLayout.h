@@ -0,0 +1,345 @@
+#ifndef NETLAYOUT_H
+#define NETLAYOUT_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <iostream>
+#include <vector>
+#include <cfloat>
+#include <tuple>
+#include <algorithm>
+
+#include "Face.h"
+#include "FaceAdjacency.h"
+
+using namespace std;
+
+// flat position of every face of a spanning tree, computed from the rest pose of the faces
+// the meshes are only read (backupVertices and the original axis) so a layout can be built while the shape is animating
+// faces can be placed one at a time so a search can check each face as it is added
+// the pieces of a forest are flattened onto the plane of the first root by their pieceTransforms (see placePieces)
+class NetLayout {
+public:
+	FaceAdjacency* adjacency = nullptr;
+
+	// rest pose -> flattened pose of each face
+	vector<glm::mat4> transforms;
+
+	// whether each face has been placed yet
+	vector<bool> placed;
+
+	// flattened triangles as 2d points on the plane of the root face (3 points per triangle)
+	// the triangles of face i are triangleOffsets[i] to triangleOffsets[i + 1] - 1
+	vector<glm::vec2> points;
+	vector<int> triangleOffsets;
+
+	// 2d bounds of each placed face
+	vector<glm::vec2> faceMin;
+	vector<glm::vec2> faceMax;
+
+	// plane of the root face that the net is flattened onto
+	glm::vec3 origin;
+	glm::vec3 uAxis;
+	glm::vec3 vAxis;
+
+	NetLayout() {}
+
+	NetLayout(FaceAdjacency* adjacency) {
+		init(adjacency);
+	}
+
+	// size the buffers for the faces of adjacency (only needed once per adjacency)
+	void init(FaceAdjacency* adjacency) {
+		this->adjacency = adjacency;
+
+		int faceCount = adjacency->faceCount();
+
+		triangleOffsets.assign(faceCount + 1, 0);
+		for (int i = 0; i < faceCount; i++) {
+			triangleOffsets[i + 1] = triangleOffsets[i] + adjacency->faces[i]->mesh->indices.size() / 3;
+		}
+
+		points.assign(triangleOffsets[faceCount] * 3, glm::vec2(0));
+		transforms.assign(faceCount, glm::mat4(1.0f));
+		placed.assign(faceCount, false);
+		faceMin.assign(faceCount, glm::vec2(0));
+		faceMax.assign(faceCount, glm::vec2(0));
+	}
+
+	// remove every face
+	void clear() {
+		placed.assign(placed.size(), false);
+	}
+
+	// lay out a whole tree onto the plane of its root face (parents are always placed before their children)
+	void build(SpanningTree &tree) {
+		clear();
+
+		if (tree.order.empty()) {
+			return;
+		}
+
+		placeRoot(tree.root());
+		placeTree(tree);
+	}
+
+	// lay out a whole tree onto a given plane instead (the shape's x/z plane is origin 0 with the axis (1, 0, 0) and (0, 0, 1))
+	void build(SpanningTree &tree, glm::vec3 origin, glm::vec3 uAxis, glm::vec3 vAxis) {
+		clear();
+
+		if (tree.order.empty()) {
+			return;
+		}
+
+		this->origin = origin;
+		this->uAxis = uAxis;
+		this->vAxis = vAxis;
+
+		place(tree.root(), glm::mat4(1.0f));
+		placeTree(tree);
+	}
+
+	// returns the minimum and maximum corners of the placed faces (returns "0,0 0,0" if nothing is placed)
+	std::tuple<glm::vec2, glm::vec2> findBounds() {
+		glm::vec2 low = glm::vec2(FLT_MAX);
+		glm::vec2 high = glm::vec2(-FLT_MAX);
+
+		for (int i = 0; i < placed.size(); i++) {
+			if (placed[i] && triangleOffsets[i] != triangleOffsets[i + 1]) {
+				low = glm::min(low, faceMin[i]);
+				high = glm::max(high, faceMax[i]);
+			}
+		}
+
+		if (low.x > high.x) {
+			return std::make_tuple(glm::vec2(0), glm::vec2(0));
+		}
+
+		return std::make_tuple(low, high);
+	}
+
+	// the root stays where it is and sets the plane of the net
+	void placeRoot(int face) {
+		glm::vec3 normal = faceNormal(face);
+
+		origin = facePoint(face);
+
+		// any direction on the plane works as the first axis, use the one furthest from the normal for precision
+		glm::vec3 helper = fabs(normal.x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 0, 1);
+		uAxis = glm::normalize(glm::cross(helper, normal));
+		vAxis = glm::cross(normal, uAxis);
+
+		place(face, glm::mat4(1.0f));
+	}
+
+	// fold face flat about the hinge edge it shares with its (already placed) parent
+	void placeFace(int face, int parent, int edge) {
+		place(face, transforms[parent] * hingeMatrix(adjacency->hinge(parent, edge)));
+	}
+
+	// rotation that flattens the hinge of axis in its rest pose
+	static glm::mat4 hingeMatrix(Face::Axis* axis, float progress = 1.0f) {
+		glm::mat4 matrix(1.0f);
+
+		if (axis == nullptr) {
+			return matrix;
+		}
+
+		matrix = glm::translate(matrix, axis->originalPoint);
+		matrix = glm::rotate(matrix, axis->originalAngle * progress, axis->originalLine);
+		matrix = glm::translate(matrix, -axis->originalPoint);
+
+		return matrix;
+	}
+
+	// turn the rest pose of face flat onto the plane of the net (facing the same way as the root) without sliding it along the plane
+	glm::mat4 flattenMatrix(int face) {
+		glm::vec3 from = faceNormal(face);
+		glm::vec3 to = glm::cross(uAxis, vAxis);
+		glm::vec3 point = facePoint(face);
+
+		glm::mat4 matrix = glm::translate(glm::mat4(1.0f), to * glm::dot(origin - point, to) + point);
+
+		glm::vec3 axis = glm::cross(from, to);
+		float angle = acos(glm::clamp(glm::dot(from, to), -1.0f, 1.0f));
+
+		if (glm::length(axis) > 0.0001f) {
+			matrix = glm::rotate(matrix, angle, glm::normalize(axis));
+		}
+		else if (angle > 1.0f) {
+			// upside down, any axis on the plane turns it over
+			matrix = glm::rotate(matrix, angle, uAxis);
+		}
+
+		return glm::translate(matrix, -point);
+	}
+
+	// work out the pieceTransforms of a forest: every piece is turned flat onto the plane of the first root and set down in
+	// rows next to the first piece (tallest first so the rows stay even), the first piece never moves
+	static void placePieces(FaceAdjacency* adjacency, SpanningTree &tree) {
+		tree.pieceTransforms.clear();
+
+		if (tree.pieceCount() < 2) {
+			return;
+		}
+
+		NetLayout layout(adjacency);
+		layout.placeRoot(tree.root());
+
+		// where each piece starts in the order (and one past the end)
+		vector<int> starts(1, 0);
+		for (int i = 1; i < tree.order.size(); i++) {
+			if (tree.parent[tree.order[i]] == -1) {
+				starts.push_back(i);
+				tree.pieceTransforms.push_back(layout.flattenMatrix(tree.order[i]));
+			}
+		}
+		starts.push_back(tree.order.size());
+
+		// lay the pieces out where they were turned flat (on top of each other for now) to measure them
+		layout.placeTree(tree);
+
+		int pieces = starts.size() - 1;
+		vector<glm::vec2> low(pieces, glm::vec2(FLT_MAX));
+		vector<glm::vec2> high(pieces, glm::vec2(-FLT_MAX));
+		float area = 0;
+
+		for (int p = 0; p < pieces; p++) {
+			for (int i = starts[p]; i < starts[p + 1]; i++) {
+				low[p] = glm::min(low[p], layout.faceMin[tree.order[i]]);
+				high[p] = glm::max(high[p], layout.faceMax[tree.order[i]]);
+			}
+
+			glm::vec2 size = high[p] - low[p];
+			area += size.x * size.y;
+		}
+
+		vector<int> sorted;
+		for (int p = 1; p < pieces; p++) {
+			sorted.push_back(p);
+		}
+		std::sort(sorted.begin(), sorted.end(), [&](int a, int b) {
+			return high[a].y - low[a].y > high[b].y - low[b].y;
+		});
+
+		// rows at least as wide as the first piece, wider when the pieces would make the whole net tall and thin
+		float rowWidth = max(high[0].x - low[0].x, sqrt(area));
+		float gap = rowWidth * pieceGap;
+
+		glm::vec2 cursor = glm::vec2(low[0].x, high[0].y + gap);
+		float rowHeight = 0;
+
+		for (int i = 0; i < sorted.size(); i++) {
+			int p = sorted[i];
+			glm::vec2 size = high[p] - low[p];
+
+			if (cursor.x > low[0].x && cursor.x + size.x > low[0].x + rowWidth) {
+				cursor = glm::vec2(low[0].x, cursor.y + rowHeight + gap);
+				rowHeight = 0;
+			}
+
+			glm::vec2 offset = cursor - low[p];
+			tree.pieceTransforms[p - 1] = glm::translate(glm::mat4(1.0f), layout.uAxis * offset.x + layout.vAxis * offset.y) * tree.pieceTransforms[p - 1];
+
+			cursor.x += size.x + gap;
+			rowHeight = max(rowHeight, size.y);
+		}
+	}
+
+	// space left between the pieces of a forest (a share of the row width)
+	static constexpr float pieceGap = 0.05f;
+
+	// rigid move part way from the rest pose to transform, turning about pivot while pivot slides in a straight line
+	static glm::mat4 moveMatrix(const glm::mat4 &transform, glm::vec3 pivot, float progress) {
+		glm::quat turn = glm::slerp(glm::quat(1, 0, 0, 0), glm::quat_cast(glm::mat3(transform)), progress);
+		glm::vec3 target = glm::vec3(transform * glm::vec4(pivot, 1.0f));
+
+		glm::mat4 matrix = glm::translate(glm::mat4(1.0f), glm::mix(pivot, target, progress));
+		matrix = matrix * glm::mat4_cast(turn);
+
+		return glm::translate(matrix, -pivot);
+	}
+
+	// first corner of a face in its rest pose
+	glm::vec3 facePoint(int face) {
+		vector<Vertex>* vertices = &adjacency->faces[face]->mesh->backupVertices;
+		vector<unsigned int>* indices = &adjacency->faces[face]->mesh->indices;
+
+		return indices->empty() ? glm::vec3(0) : (*vertices)[(*indices)[0]].Position;
+	}
+
+	// outward normal of a face in its rest pose (up if the face has no area)
+	glm::vec3 faceNormal(int face) {
+		vector<Vertex>* vertices = &adjacency->faces[face]->mesh->backupVertices;
+		vector<unsigned int>* indices = &adjacency->faces[face]->mesh->indices;
+
+		glm::vec3 normal = glm::vec3(0);
+		for (int i = 0; i + 2 < indices->size(); i += 3) {
+			glm::vec3 a = (*vertices)[(*indices)[i]].Position;
+			glm::vec3 b = (*vertices)[(*indices)[i + 1]].Position;
+			glm::vec3 c = (*vertices)[(*indices)[i + 2]].Position;
+
+			normal += glm::cross(b - a, c - a);
+		}
+
+		if (glm::length(normal) > 0) {
+			return glm::normalize(normal);
+		}
+
+		return glm::vec3(0, 1, 0);
+	}
+
+	// returns true if the 2d bounds of faces a and b overlap
+	bool boundsOverlap(int a, int b, float margin = 0.0f) {
+		return faceMin[a].x < faceMax[b].x - margin && faceMin[b].x < faceMax[a].x - margin && faceMin[a].y < faceMax[b].y - margin && faceMin[b].y < faceMax[a].y - margin;
+	}
+
+private:
+	void placeTree(SpanningTree &tree) {
+		int piece = 0;
+
+		for (int i = 1; i < tree.order.size(); i++) {
+			int face = tree.order[i];
+
+			if (tree.parent[face] == -1) {
+				// a piece of a forest, left in its rest pose until placePieces has found it a spot
+				place(face, piece < tree.pieceTransforms.size() ? tree.pieceTransforms[piece] : glm::mat4(1.0f));
+				piece++;
+				continue;
+			}
+
+			placeFace(face, tree.parent[face], tree.parentEdge[face]);
+		}
+	}
+
+	void place(int face, glm::mat4 transform) {
+		transforms[face] = transform;
+		placed[face] = true;
+
+		vector<Vertex>* vertices = &adjacency->faces[face]->mesh->backupVertices;
+		vector<unsigned int>* indices = &adjacency->faces[face]->mesh->indices;
+
+		glm::vec2 low = glm::vec2(FLT_MAX);
+		glm::vec2 high = glm::vec2(-FLT_MAX);
+
+		int start = triangleOffsets[face] * 3;
+		int count = (triangleOffsets[face + 1] - triangleOffsets[face]) * 3;
+
+		for (int i = 0; i < count; i++) {
+			glm::vec3 pos = glm::vec3(transform * glm::vec4((*vertices)[(*indices)[i]].Position, 1.0f)) - origin;
+			glm::vec2 flat = glm::vec2(glm::dot(pos, uAxis), glm::dot(pos, vAxis));
+
+			points[start + i] = flat;
+
+			low = glm::min(low, flat);
+			high = glm::max(high, flat);
+		}
+
+		faceMin[face] = low;
+		faceMax[face] = high;
+	}
+};
+
+#endif
@@ -0,0 +1,329 @@
+#ifndef NETOVERLAP_H
+#define NETOVERLAP_H
+
+#include <glm/glm.hpp>
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+
+#include "NetLayout.h"
+
+using namespace std;
+
+// overlap queries between the flattened faces of a NetLayout
+// broad phase: a uniform grid (hashed so the net can spread anywhere) that every inserted face registers in by its 2d bounds
+// narrow phase: an exact separating axis test between the triangles of two faces
+// faces can be inserted and removed one at a time so moving a subtree only costs the faces that moved
+class NetOverlap {
+public:
+	// faces closer than this are only touching and do not count as overlapping
+	static constexpr float overlapMargin = 0.0001f;
+
+	NetLayout* layout = nullptr;
+
+	// width of one grid cell
+	float cellSize = 1.0f;
+
+	// cell coordinates are kept within this so a face thrown far out cannot overflow the cast to int
+	static constexpr float cellLimit = 1 << 20;
+
+	NetOverlap() {}
+
+	NetOverlap(NetLayout* layout) {
+		init(layout);
+	}
+
+	// size the grid for the faces of layout (the layout must already be initialized)
+	void init(NetLayout* layout) {
+		this->layout = layout;
+
+		int faceCount = layout->adjacency->faceCount();
+
+		// cells about the size of an average face keep both the cells per face and the faces per cell small
+		// (a face is as wide flat as it is in 3d so its rest pose size can be used before anything is placed)
+		float total = 0;
+		for (int i = 0; i < faceCount; i++) {
+			total += faceSize(layout->adjacency->faces[i]);
+		}
+
+		cellSize = faceCount > 0 && total > 0 ? total / faceCount : 1.0f;
+
+		inserted.assign(faceCount, false);
+		faceCells.assign(faceCount, glm::ivec4(0));
+		stamps.assign(faceCount, 0);
+		stamp = 0;
+
+		cells.clear();
+	}
+
+	void clear() {
+		cells.clear();
+		inserted.assign(inserted.size(), false);
+	}
+
+	// register a placed face in the grid
+	// a face with bounds that are not finite (a NaN or infinite pose) gets no cells but still counts as overlapping
+	void insert(int face) {
+		if (inserted[face]) {
+			return;
+		}
+
+		if (!finiteBounds(face)) {
+			faceCells[face] = glm::ivec4(0, 0, -1, -1);
+			inserted[face] = true;
+			return;
+		}
+
+		glm::ivec4 range = cellRange(face);
+		faceCells[face] = range;
+
+		for (int x = range.x; x <= range.z; x++) {
+			for (int y = range.y; y <= range.w; y++) {
+				cells[cellKey(x, y)].push_back(face);
+			}
+		}
+
+		inserted[face] = true;
+	}
+
+	// take a face out of the grid (call before the face is moved)
+	void remove(int face) {
+		if (!inserted[face]) {
+			return;
+		}
+
+		glm::ivec4 range = faceCells[face];
+
+		for (int x = range.x; x <= range.z; x++) {
+			for (int y = range.y; y <= range.w; y++) {
+				auto cell = cells.find(cellKey(x, y));
+
+				if (cell == cells.end()) {
+					continue;
+				}
+
+				vector<int>* list = &cell->second;
+				for (int i = 0; i < list->size(); i++) {
+					if ((*list)[i] == face) {
+						(*list)[i] = list->back();
+						list->pop_back();
+						break;
+					}
+				}
+
+				if (list->empty()) {
+					cells.erase(cell);
+				}
+			}
+		}
+
+		inserted[face] = false;
+	}
+
+	bool contains(int face) {
+		return inserted[face];
+	}
+
+	// returns the number of faces in the grid that overlap face (the face does not have to be in the grid itself)
+	// fills found with them if given, stops at the first one if stopAtFirst
+	// a face with bounds that are not finite always overlaps so a broken net is never taken as clean
+	int findOverlaps(int face, vector<int>* found = nullptr, bool stopAtFirst = false) {
+		if (!finiteBounds(face)) {
+			return 1;
+		}
+
+		glm::ivec4 range = cellRange(face);
+		int count = 0;
+
+		// faces spanning several cells are only tested once per query
+		nextStamp();
+		stamps[face] = stamp;
+
+		for (int x = range.x; x <= range.z; x++) {
+			for (int y = range.y; y <= range.w; y++) {
+				auto cell = cells.find(cellKey(x, y));
+
+				if (cell == cells.end()) {
+					continue;
+				}
+
+				for (int i = 0; i < cell->second.size(); i++) {
+					int other = cell->second[i];
+
+					if (stamps[other] == stamp) {
+						continue;
+					}
+					stamps[other] = stamp;
+
+					if (facesOverlap(*layout, face, other)) {
+						count++;
+
+						if (found != nullptr) {
+							found->push_back(other);
+						}
+						if (stopAtFirst) {
+							return count;
+						}
+					}
+				}
+			}
+		}
+
+		return count;
+	}
+
+	bool overlapsAny(int face) {
+		return findOverlaps(face, nullptr, true) > 0;
+	}
+
+	// number of overlapping face pairs among the faces in the grid
+	int countPairs() {
+		int pairs = 0;
+		vector<int> found;
+
+		for (int i = 0; i < inserted.size(); i++) {
+			if (!inserted[i]) {
+				continue;
+			}
+
+			// a face that could not be placed is a pair on its own
+			if (!finiteBounds(i)) {
+				pairs++;
+				continue;
+			}
+
+			found.clear();
+			findOverlaps(i, &found);
+
+			// every pair is found from both sides
+			for (int j = 0; j < found.size(); j++) {
+				if (found[j] > i) {
+					pairs++;
+				}
+			}
+		}
+
+		return pairs;
+	}
+
+	// returns true if two flattened triangles overlap by more than margin (separating axis test)
+	static bool trianglesOverlap(const glm::vec2* a, const glm::vec2* b, float margin = overlapMargin) {
+		const glm::vec2* triangles[2] = { a, b };
+
+		// a triangle pair is seperate if one of the 6 edge normals seperates them
+		for (int t = 0; t < 2; t++) {
+			for (int i = 0; i < 3; i++) {
+				glm::vec2 edge = triangles[t][(i + 1) % 3] - triangles[t][i];
+				glm::vec2 normal = glm::vec2(-edge.y, edge.x);
+
+				float length = glm::length(normal);
+				if (length == 0) {
+					continue;
+				}
+				normal /= length;
+
+				float minA = FLT_MAX, maxA = -FLT_MAX, minB = FLT_MAX, maxB = -FLT_MAX;
+				for (int j = 0; j < 3; j++) {
+					float projA = glm::dot(a[j], normal);
+					float projB = glm::dot(b[j], normal);
+
+					minA = min(minA, projA);
+					maxA = max(maxA, projA);
+					minB = min(minB, projB);
+					maxB = max(maxB, projB);
+				}
+
+				if (maxA - margin <= minB || maxB - margin <= minA) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// returns true if two placed faces of layout overlap
+	static bool facesOverlap(NetLayout &layout, int a, int b, float margin = overlapMargin) {
+		if (!layout.boundsOverlap(a, b, margin)) {
+			return false;
+		}
+
+		for (int i = layout.triangleOffsets[a]; i < layout.triangleOffsets[a + 1]; i++) {
+			for (int j = layout.triangleOffsets[b]; j < layout.triangleOffsets[b + 1]; j++) {
+				if (trianglesOverlap(&layout.points[i * 3], &layout.points[j * 3], margin)) {
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+private:
+	// grid cell -> faces registered in it
+	unordered_map<int64_t, vector<int>> cells;
+
+	// cells covered by each inserted face (min x, min y, max x, max y)
+	vector<glm::ivec4> faceCells;
+	vector<bool> inserted;
+
+	// query stamps so a face found in several cells is only tested once
+	vector<unsigned int> stamps;
+	unsigned int stamp = 0;
+
+	void nextStamp() {
+		stamp++;
+
+		// restart the stamps if the counter wraps around
+		if (stamp == 0) {
+			stamps.assign(stamps.size(), 0);
+			stamp = 1;
+		}
+	}
+
+	static int64_t cellKey(int x, int y) {
+		return ((int64_t)x << 32) ^ (int64_t)(uint32_t)y;
+	}
+
+	int cellCoord(float value) {
+		return (int)floor(glm::clamp(value / cellSize, -cellLimit, cellLimit));
+	}
+
+	bool finiteBounds(int face) {
+		glm::vec2 low = layout->faceMin[face];
+		glm::vec2 high = layout->faceMax[face];
+
+		return isfinite(low.x) && isfinite(low.y) && isfinite(high.x) && isfinite(high.y);
+	}
+
+	glm::ivec4 cellRange(int face) {
+		return glm::ivec4(cellCoord(layout->faceMin[face].x), cellCoord(layout->faceMin[face].y), cellCoord(layout->faceMax[face].x), cellCoord(layout->faceMax[face].y));
+	}
+
+	// longest side of the bounding box of a face
+	static float faceSize(Face* face) {
+		vector<Vertex>* vertices = &face->mesh->backupVertices;
+
+		if (vertices->empty()) {
+			return 0;
+		}
+
+		glm::vec3 low = (*vertices)[0].Position;
+		glm::vec3 high = low;
+
+		for (int i = 1; i < vertices->size(); i++) {
+			low = glm::min(low, (*vertices)[i].Position);
+			high = glm::max(high, (*vertices)[i].Position);
+		}
+
+		glm::vec3 size = high - low;
+
+		return max(size.x, max(size.y, size.z));
+	}
+};
+
+#endif
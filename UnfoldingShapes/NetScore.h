@@ -0,0 +1,190 @@
+#ifndef NETSCORE_H
+#define NETSCORE_H
+
+#include <glm/glm.hpp>
+
+#include <iostream>
+#include <vector>
+#include <cfloat>
+#include <algorithm>
+
+#include "FaceAdjacency.h"
+#include "NetLayout.h"
+#include "NetOverlap.h"
+
+using namespace std;
+
+// how good the net of a spanning tree is, measured from the tree and the rest pose alone so candidates can be ranked
+// without touching the shape (everything is one pass over the faces or edges except the hull, which sorts the points)
+struct NetScore {
+	// bounds of the net on the plane it was laid out on
+	glm::vec2 low = glm::vec2(0);
+	glm::vec2 high = glm::vec2(0);
+
+	float boundingArea = 0;
+	float hullArea = 0;
+
+	// longer side of the bounds over the shorter one (1 is square)
+	float aspectRatio = 1;
+
+	// total length of the edges that are cut open (hinges are not counted, neither are the edges of open meshes)
+	float cutLength = 0;
+
+	// pairs of faces that overlap in the net
+	int overlaps = 0;
+
+	// most hinges between the root and a face (a step based unfold takes longer the deeper the tree)
+	int depth = 0;
+
+	// seperate pieces the net is cut into (1 unless the tree is a forest)
+	int pieces = 1;
+
+	// lay tree out on the table plane (the xz plane like findUnfoldSize) and score it
+	static NetScore measure(FaceAdjacency* adjacency, SpanningTree &tree) {
+		NetLayout layout(adjacency);
+		layout.build(tree, glm::vec3(0), glm::vec3(1, 0, 0), glm::vec3(0, 0, 1));
+
+		return measure(layout, tree);
+	}
+
+	// score a tree that was already laid out
+	static NetScore measure(NetLayout &layout, SpanningTree &tree) {
+		NetScore score;
+
+		std::tie(score.low, score.high) = layout.findBounds();
+
+		glm::vec2 size = score.high - score.low;
+		score.boundingArea = size.x * size.y;
+
+		float shorter = min(size.x, size.y);
+		score.aspectRatio = shorter > 0 ? max(size.x, size.y) / shorter : 1.0f;
+
+		score.hullArea = measureHull(layout);
+		score.cutLength = measureCuts(layout.adjacency, tree);
+		score.depth = measureDepth(tree);
+		score.pieces = tree.pieceCount();
+
+		NetOverlap overlap(&layout);
+		for (int i = 0; i < tree.order.size(); i++) {
+			overlap.insert(tree.order[i]);
+		}
+		score.overlaps = overlap.countPairs();
+
+		return score;
+	}
+
+	// fewer overlaps first, then the smaller bounding area
+	bool betterThan(const NetScore &other) const {
+		if (overlaps != other.overlaps) {
+			return overlaps < other.overlaps;
+		}
+
+		return boundingArea < other.boundingArea;
+	}
+
+	void print() const {
+		std::cout << "overlapping pairs: " << overlaps << ", pieces: " << pieces << ", bounding area: " << boundingArea << ", hull area: " << hullArea << ", aspect ratio: " << aspectRatio << ", cut length: " << cutLength << ", depth: " << depth << std::endl;
+	}
+
+	// area of the convex hull of every placed triangle (monotone chain)
+	static float measureHull(NetLayout &layout) {
+		vector<glm::vec2> points;
+		points.reserve(layout.points.size());
+
+		for (int face = 0; face < layout.placed.size(); face++) {
+			if (layout.placed[face]) {
+				points.insert(points.end(), layout.points.begin() + layout.triangleOffsets[face] * 3, layout.points.begin() + layout.triangleOffsets[face + 1] * 3);
+			}
+		}
+
+		if (points.size() < 3) {
+			return 0;
+		}
+
+		std::sort(points.begin(), points.end(), [](const glm::vec2 &a, const glm::vec2 &b) {
+			return a.x < b.x || (a.x == b.x && a.y < b.y);
+		});
+
+		// lower hull left to right then upper hull right to left, popping every point that does not turn left
+		vector<glm::vec2> hull(points.size() * 2);
+		int count = 0;
+
+		for (int i = 0; i < points.size(); i++) {
+			while (count >= 2 && cross(hull[count - 2], hull[count - 1], points[i]) <= 0) {
+				count--;
+			}
+			hull[count++] = points[i];
+		}
+
+		for (int i = points.size() - 2, lower = count + 1; i >= 0; i--) {
+			while (count >= lower && cross(hull[count - 2], hull[count - 1], points[i]) <= 0) {
+				count--;
+			}
+			hull[count++] = points[i];
+		}
+
+		// the last point is the first one again
+		count--;
+
+		// shoelace formula
+		float area = 0;
+		for (int i = 0; i < count; i++) {
+			glm::vec2 a = hull[i];
+			glm::vec2 b = hull[(i + 1) % count];
+
+			area += a.x * b.y - b.x * a.y;
+		}
+
+		return abs(area) * 0.5f;
+	}
+
+	// length of every edge between two faces that the tree does not hinge (each edge is listed from both faces so only the
+	// direction from the lower face is counted)
+	static float measureCuts(FaceAdjacency* adjacency, SpanningTree &tree) {
+		float length = 0;
+
+		for (int face = 0; face < adjacency->faceCount(); face++) {
+			for (int e = adjacency->offsets[face]; e < adjacency->offsets[face + 1]; e++) {
+				int neighbor = adjacency->neighbors[e];
+
+				if (neighbor <= face || tree.parent[neighbor] == face || tree.parent[face] == neighbor) {
+					continue;
+				}
+
+				Face::Axis* axis = adjacency->hinge(face, e);
+				if (axis != nullptr) {
+					length += glm::distance(axis->p1, axis->p2);
+				}
+			}
+		}
+
+		return length;
+	}
+
+	// most hinges between a root and any face (parents come before their children in the order)
+	static int measureDepth(SpanningTree &tree) {
+		vector<int> levels(tree.parent.size(), 0);
+		int deepest = 0;
+
+		for (int i = 1; i < tree.order.size(); i++) {
+			int face = tree.order[i];
+
+			if (tree.parent[face] == -1) {
+				continue;
+			}
+
+			levels[face] = levels[tree.parent[face]] + 1;
+			deepest = max(deepest, levels[face]);
+		}
+
+		return deepest;
+	}
+
+private:
+	// positive if a, b, c turn left
+	static float cross(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c) {
+		return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	}
+};
+
+#endif
@@ -0,0 +1,356 @@
+#ifndef NETSEARCH_H
+#define NETSEARCH_H
+
+#include <glm/glm.hpp>
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+#include "Face.h"
+#include "FaceAdjacency.h"
+#include "NetLayout.h"
+#include "NetOverlap.h"
+
+using namespace std;
+
+// searches random spanning trees of a shape for a net that lays flat without overlapping itself
+// every worker thread grows its own trees outward from the root one face at a time and checks each new face as soon as it is placed,
+// a face that would overlap is left for another hinge to reach so most trees are repaired instead of thrown away.
+// faces that still overlap are then moved (with everything hinged below them) onto other neighbors one edge swap at a time.
+// the search stops at the first overlap free net or when the time runs out and returns the best tree it found.
+// pass a Progress to watch the search from another thread, take the best tree so far or cancel it early.
+class NetSearch {
+public:
+	struct Result {
+		SpanningTree tree;
+
+		// overlapping face pairs in the net (0 for a valid net)
+		int overlaps = -1;
+
+		// trees tried across all threads
+		int candidates = 0;
+
+		bool valid() {
+			return overlaps == 0;
+		}
+	};
+
+	// shared between a running search and whoever started it
+	struct Progress {
+		// set to make every worker stop after the step it is on
+		atomic<bool> cancelled{ false };
+
+		// goes up every time a better tree is found
+		atomic<int> improvements{ 0 };
+
+		atomic<int> candidates{ 0 };
+
+		// overlapping pairs in the best tree so far (-1 until the first tree is done)
+		atomic<int> bestOverlaps{ -1 };
+
+		// copy of the best tree found so far (overlaps is -1 until the first tree is done)
+		Result getBest() {
+			lock_guard<mutex> lock(bestLock);
+			return best;
+		}
+
+	private:
+		friend class NetSearch;
+
+		mutex bestLock;
+		Result best;
+	};
+
+	// budget is in seconds, threads = 0 uses every core
+	static Result search(FaceAdjacency* adjacency, float budget = 2.0f, int threads = 0, Progress* progress = nullptr) {
+		Result best;
+
+		if (adjacency->faceCount() == 0 || adjacency->root == -1) {
+			return best;
+		}
+
+		if (threads <= 0) {
+			threads = max(1, (int)thread::hardware_concurrency());
+		}
+
+		auto deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<float>(budget));
+
+		mutex bestLock;
+		atomic<bool> finished(false);
+		atomic<int> candidates(0);
+
+		// stands in for a progress nobody is watching so the workers never have to check for one
+		Progress unwatched;
+		if (progress == nullptr) {
+			progress = &unwatched;
+		}
+
+		random_device seeder;
+
+		vector<thread> workers;
+		for (int t = 0; t < threads; t++) {
+			unsigned int seed = seeder() + t;
+
+			workers.push_back(thread([&, seed]() {
+				mt19937 random(seed);
+
+				NetLayout layout(adjacency);
+				NetOverlap overlap(&layout);
+				SpanningTree tree;
+
+				// always try at least one tree even with no time budget
+				do {
+					int overlaps = growTree(adjacency, layout, overlap, tree, random);
+
+					if (overlaps > 0) {
+						overlaps = repairTree(adjacency, layout, overlap, tree, random, deadline, &progress->cancelled);
+					}
+
+					candidates++;
+					progress->candidates++;
+
+					lock_guard<mutex> lock(bestLock);
+
+					if (best.overlaps == -1 || overlaps < best.overlaps) {
+						best.tree = tree;
+						best.overlaps = overlaps;
+
+						// publish it (the children are only needed by the copy that leaves the search)
+						lock_guard<mutex> published(progress->bestLock);
+						progress->best = best;
+						progress->best.candidates = candidates;
+						progress->best.tree.buildChildren();
+						progress->bestOverlaps = overlaps;
+						progress->improvements++;
+					}
+
+					if (overlaps == 0) {
+						finished = true;
+					}
+				} while (!finished && !progress->cancelled && chrono::steady_clock::now() < deadline);
+			}));
+		}
+
+		for (int t = 0; t < workers.size(); t++) {
+			workers[t].join();
+		}
+
+		best.candidates = candidates;
+		best.tree.buildChildren();
+
+		return best;
+	}
+
+	// move the subtree hanging from face onto newParent through newEdge (an edge of newParent that leads to face)
+	// only the faces that move are taken out of the grid and checked again, so the cost depends on the size of the subtree and not the net.
+	// the swap is kept if the moved faces overlap fewer of the other faces than before, otherwise everything is put back.
+	// subtree must hold face and its descendants with parents first (SpanningTree::collectSubtree) and must not contain newParent.
+	static bool trySwap(NetLayout &layout, NetOverlap &overlap, SpanningTree &tree, vector<int> &subtree, int newParent, int newEdge) {
+		int face = subtree[0];
+		int oldParent = tree.parent[face];
+		int oldEdge = tree.parentEdge[face];
+
+		for (int i = 0; i < subtree.size(); i++) {
+			overlap.remove(subtree[i]);
+		}
+
+		// the subtree moves as one rigid piece so only overlaps with the rest of the net can change
+		int before = 0;
+		for (int i = 0; i < subtree.size(); i++) {
+			before += overlap.findOverlaps(subtree[i]);
+		}
+
+		int after = before;
+		if (before > 0) {
+			placeSubtree(layout, tree, subtree, newParent, newEdge);
+
+			after = 0;
+			for (int i = 0; i < subtree.size() && after < before; i++) {
+				after += overlap.findOverlaps(subtree[i]);
+			}
+
+			if (after < before) {
+				tree.parent[face] = newParent;
+				tree.parentEdge[face] = newEdge;
+			}
+			else {
+				placeSubtree(layout, tree, subtree, oldParent, oldEdge);
+			}
+		}
+
+		for (int i = 0; i < subtree.size(); i++) {
+			overlap.insert(subtree[i]);
+		}
+
+		return after < before;
+	}
+
+private:
+	// lay the subtree out again hanging from parent through edge
+	static void placeSubtree(NetLayout &layout, SpanningTree &tree, vector<int> &subtree, int parent, int edge) {
+		layout.placeFace(subtree[0], parent, edge);
+
+		for (int i = 1; i < subtree.size(); i++) {
+			layout.placeFace(subtree[i], tree.parent[subtree[i]], tree.parentEdge[subtree[i]]);
+		}
+	}
+
+	// grow one random spanning tree (prim's algorithm with random edge weights) and return the number of faces that had to overlap
+	static int growTree(FaceAdjacency* adjacency, NetLayout &layout, NetOverlap &overlap, SpanningTree &tree, mt19937 &random) {
+		tree.reset(adjacency->faceCount());
+		layout.clear();
+		overlap.clear();
+
+		uniform_real_distribution<float> weight(0.0f, 1.0f);
+
+		// frontier of (weight, edge, face the edge starts from)
+		typedef pair<float, pair<int, int>> Hinge;
+		priority_queue<Hinge, vector<Hinge>, greater<Hinge>> frontier;
+
+		// hinges that were skipped because they overlapped, used to finish the tree if nothing else reaches their face
+		vector<pair<int, int>> rejected;
+
+		auto addFace = [&](int face) {
+			tree.order.push_back(face);
+			overlap.insert(face);
+
+			for (int e = adjacency->offsets[face]; e < adjacency->offsets[face + 1]; e++) {
+				if (!layout.placed[adjacency->neighbors[e]]) {
+					frontier.push(Hinge(weight(random), pair<int, int>(e, face)));
+				}
+			}
+		};
+
+		layout.placeRoot(adjacency->root);
+		addFace(adjacency->root);
+
+		while (!frontier.empty()) {
+			int edge = frontier.top().second.first;
+			int parent = frontier.top().second.second;
+			frontier.pop();
+
+			int face = adjacency->neighbors[edge];
+			if (layout.placed[face]) {
+				continue;
+			}
+
+			// early rejection, try the face against the net before committing to this hinge
+			layout.placeFace(face, parent, edge);
+
+			if (overlap.overlapsAny(face)) {
+				layout.placed[face] = false;
+				rejected.push_back(pair<int, int>(edge, parent));
+				continue;
+			}
+
+			tree.parent[face] = parent;
+			tree.parentEdge[face] = edge;
+			addFace(face);
+		}
+
+		// attach whatever is left through hinges that overlap so the result is always a full spanning tree
+		int overlaps = 0;
+		for (int i = 0; i < rejected.size(); i++) {
+			int edge = rejected[i].first;
+			int parent = rejected[i].second;
+			int face = adjacency->neighbors[edge];
+
+			if (layout.placed[face]) {
+				continue;
+			}
+
+			layout.placeFace(face, parent, edge);
+
+			tree.parent[face] = parent;
+			tree.parentEdge[face] = edge;
+			tree.order.push_back(face);
+			overlap.insert(face);
+
+			overlaps++;
+
+			// its unplaced neighbors can only be reached through it now
+			for (int e = adjacency->offsets[face]; e < adjacency->offsets[face + 1]; e++) {
+				if (!layout.placed[adjacency->neighbors[e]]) {
+					rejected.push_back(pair<int, int>(e, face));
+				}
+			}
+		}
+
+		return overlaps;
+	}
+
+	// local search over edge swaps, every overlapping face tries hanging its subtree from its other neighbors
+	// returns the number of overlapping face pairs left (gives up early at the deadline or once stop is set)
+	static int repairTree(FaceAdjacency* adjacency, NetLayout &layout, NetOverlap &overlap, SpanningTree &tree, mt19937 &random, chrono::steady_clock::time_point deadline, const atomic<bool>* stop = nullptr) {
+		tree.rebuildFromParents(adjacency->root);
+
+		vector<int> subtree;
+		vector<int> hinges;
+		vector<bool> inSubtree(adjacency->faceCount(), false);
+
+		bool improved = true;
+		for (int pass = 0; pass < maxRepairPasses && improved; pass++) {
+			improved = false;
+
+			// the order is rebuilt after every swap so walk a copy
+			vector<int> faces = tree.order;
+
+			for (int i = 1; i < faces.size() && chrono::steady_clock::now() < deadline && (stop == nullptr || !*stop); i++) {
+				int face = faces[i];
+
+				if (!overlap.overlapsAny(face)) {
+					continue;
+				}
+
+				subtree.clear();
+				tree.collectSubtree(face, subtree);
+
+				for (int j = 0; j < subtree.size(); j++) {
+					inSubtree[subtree[j]] = true;
+				}
+
+				// every other neighbor outside the subtree can hold it
+				hinges.clear();
+				for (int e = adjacency->offsets[face]; e < adjacency->offsets[face + 1]; e++) {
+					int neighbor = adjacency->neighbors[e];
+
+					if (neighbor != tree.parent[face] && !inSubtree[neighbor]) {
+						hinges.push_back(neighbor);
+					}
+				}
+				shuffle(hinges.begin(), hinges.end(), random);
+
+				bool swapped = false;
+				for (int h = 0; h < hinges.size() && !swapped; h++) {
+					int edge = adjacency->findEdge(hinges[h], face);
+
+					if (edge != -1) {
+						swapped = trySwap(layout, overlap, tree, subtree, hinges[h], edge);
+					}
+				}
+
+				for (int j = 0; j < subtree.size(); j++) {
+					inSubtree[subtree[j]] = false;
+				}
+
+				if (swapped) {
+					tree.rebuildFromParents(adjacency->root);
+					improved = true;
+				}
+			}
+		}
+
+		return overlap.countPairs();
+	}
+
+	// how many times repairTree walks the whole net
+	static const int maxRepairPasses = 4;
+};
+
+#endif
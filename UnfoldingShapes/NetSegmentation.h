@@ -0,0 +1,401 @@
+#ifndef NETSEGMENTATION_H
+#define NETSEGMENTATION_H
+
+#include <glm/glm.hpp>
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include "Face.h"
+#include "FaceAdjacency.h"
+#include "NetLayout.h"
+#include "NetOverlap.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+// cuts a shape into as few pieces as it can where every piece unfolds without overlapping itself (for shapes with no single net)
+// the result is a forest: every piece is a spanning tree of a connected patch of faces and its root has no parent.
+// first a number of random partitions are grown side by side, each piece takes every face it can reach without overlapping
+// and leaves the rest for the next piece. then the pieces of the best partition try to join one of their neighbors,
+// every piece is checked on its own so the checks of a round are split between the threads.
+class NetSegmentation {
+public:
+	struct Result {
+		SpanningTree forest;
+
+		int pieces = 0;
+
+		// pieces before any of them were joined
+		int grownPieces = 0;
+
+		// rounds of joining pieces
+		int rounds = 0;
+	};
+
+	// attempts is the number of random partitions to start from, the same seed always gives the same pieces
+	static Result segment(FaceAdjacency* adjacency, int attempts = 64, unsigned int seed = 1) {
+		Result result;
+
+		if (adjacency->faceCount() == 0 || adjacency->root == -1) {
+			return result;
+		}
+
+		attempts = max(1, attempts);
+
+		// pieces are started from the faces closest to the base first so each new piece starts next to the ones before it
+		vector<int> seeds = seedOrder(adjacency);
+
+		ThreadPool pool;
+
+		vector<SpanningTree> forests(attempts);
+		vector<int> counts(attempts);
+
+		pool.parallelFor(attempts, [&](int i) {
+			seed_seq sequence{ seed, (unsigned int)i };
+			mt19937 random(sequence);
+
+			NetLayout layout(adjacency);
+			NetOverlap overlap(&layout);
+
+			// half of the partitions grow the flattest hinges first (which suits shapes with flat sides and sharp creases),
+			// the other half grow in any direction
+			float foldWeight = i % 2 == 0 ? 0.0f : flatFirstWeight;
+
+			counts[i] = growForest(adjacency, layout, overlap, forests[i], seeds, random, foldWeight);
+		});
+
+		int best = 0;
+		for (int i = 1; i < attempts; i++) {
+			if (counts[i] < counts[best]) {
+				best = i;
+			}
+		}
+
+		result.forest = forests[best];
+		result.grownPieces = counts[best];
+
+		while (joinPieces(adjacency, result.forest, pool)) {
+			result.rounds++;
+		}
+
+		result.forest.buildChildren();
+		result.pieces = result.forest.pieceCount();
+
+		return result;
+	}
+
+	// grow pieces from the seeds in turn until every face is in one (prim's algorithm with random edge weights like
+	// NetSearch::growTree, except a face that would overlap is left for a later piece), returns the number of pieces
+	// pieces only grow across hinges that can be folded so every face lies flat (a face without one starts a piece that is turned flat)
+	// foldWeight is added to the random weight of a hinge for every radian it folds (0 ignores the fold)
+	static int growForest(FaceAdjacency* adjacency, NetLayout &layout, NetOverlap &overlap, SpanningTree &forest, vector<int> &seeds, mt19937 &random, float foldWeight = 0.0f) {
+		forest.reset(adjacency->faceCount());
+		layout.clear();
+
+		uniform_real_distribution<float> weight(0.0f, 1.0f);
+
+		// frontier of (weight, edge, face the edge starts from)
+		typedef pair<float, pair<int, int>> Hinge;
+		priority_queue<Hinge, vector<Hinge>, greater<Hinge>> frontier;
+
+		auto addFace = [&](int face) {
+			forest.order.push_back(face);
+			overlap.insert(face);
+
+			for (int e = adjacency->offsets[face]; e < adjacency->offsets[face + 1]; e++) {
+				if (!layout.placed[adjacency->neighbors[e]] && adjacency->hinged(e)) {
+					frontier.push(Hinge(weight(random) + foldWeight * fabs(adjacency->hinge(face, e)->originalAngle), pair<int, int>(e, face)));
+				}
+			}
+		};
+
+		int pieces = 0;
+
+		for (int s = 0; s < seeds.size(); s++) {
+			if (layout.placed[seeds[s]]) {
+				continue;
+			}
+
+			// each piece is only checked against itself
+			overlap.clear();
+
+			layout.placeRoot(seeds[s]);
+			addFace(seeds[s]);
+			pieces++;
+
+			while (!frontier.empty()) {
+				int edge = frontier.top().second.first;
+				int parent = frontier.top().second.second;
+				frontier.pop();
+
+				int face = adjacency->neighbors[edge];
+				if (layout.placed[face]) {
+					continue;
+				}
+
+				layout.placeFace(face, parent, edge);
+
+				if (overlap.overlapsAny(face)) {
+					layout.placed[face] = false;
+					continue;
+				}
+
+				forest.parent[face] = parent;
+				forest.parentEdge[face] = edge;
+				addFace(face);
+			}
+		}
+
+		return pieces;
+	}
+
+	// fold weight of the flat first partitions (a right angle fold outweighs any random weight)
+	static constexpr float flatFirstWeight = 2.0f;
+
+	// one round of joining: every piece looks for a neighbor it can hang from without overlapping it (in parallel), then the
+	// joins are made smallest piece first, skipping any piece that already took part in a join this round (its check is out
+	// of date). returns false once no piece can join another
+	static bool joinPieces(FaceAdjacency* adjacency, SpanningTree &forest, ThreadPool &pool) {
+		int faceCount = adjacency->faceCount();
+
+		// piece of every face and the faces of every piece in tree order
+		vector<int> pieceOf(faceCount, -1);
+		vector<vector<int>> members;
+
+		for (int i = 0; i < forest.order.size(); i++) {
+			int face = forest.order[i];
+
+			if (forest.parent[face] == -1) {
+				members.push_back(vector<int>());
+			}
+
+			pieceOf[face] = members.size() - 1;
+			members.back().push_back(face);
+		}
+
+		int pieces = members.size();
+		if (pieces < 2) {
+			return false;
+		}
+
+		// hinge found for each piece: (face in the piece, face in the neighbor it hangs from), -1 if there is none
+		vector<pair<int, int>> joins(pieces, pair<int, int>(-1, -1));
+
+		// the first piece keeps its root so the base of the shape stays on the table (others can still join it)
+		pool.parallelFor(pieces - 1, [&](int i) {
+			joins[i + 1] = findJoin(adjacency, forest, pieceOf, members, i + 1);
+		});
+
+		vector<int> sorted;
+		for (int p = 0; p < pieces; p++) {
+			sorted.push_back(p);
+		}
+		std::stable_sort(sorted.begin(), sorted.end(), [&](int a, int b) {
+			return members[a].size() < members[b].size();
+		});
+
+		vector<bool> touched(pieces, false);
+		vector<bool> joined(pieces, false);
+		bool changed = false;
+
+		for (int i = 0; i < sorted.size(); i++) {
+			int piece = sorted[i];
+			int face = joins[piece].first;
+			int holder = joins[piece].second;
+
+			if (face == -1 || touched[piece] || touched[pieceOf[holder]]) {
+				continue;
+			}
+
+			touched[piece] = true;
+			touched[pieceOf[holder]] = true;
+			joined[piece] = true;
+
+			reroot(adjacency, forest, face);
+			forest.parent[face] = holder;
+			forest.parentEdge[face] = adjacency->findEdge(holder, face);
+
+			changed = true;
+		}
+
+		if (!changed) {
+			return false;
+		}
+
+		vector<int> roots;
+		for (int p = 0; p < pieces; p++) {
+			if (!joined[p]) {
+				roots.push_back(members[p][0]);
+			}
+		}
+
+		forest.rebuildFromParents(roots);
+
+		return true;
+	}
+
+private:
+	// every face in breadth first order from the root (faces that can not be reached from it go last)
+	static vector<int> seedOrder(FaceAdjacency* adjacency) {
+		int faceCount = adjacency->faceCount();
+
+		vector<int> order;
+		vector<bool> seen(faceCount, false);
+
+		order.reserve(faceCount);
+
+		for (int start = -1; start < faceCount; start++) {
+			int first = start == -1 ? adjacency->root : start;
+
+			if (seen[first]) {
+				continue;
+			}
+
+			seen[first] = true;
+			order.push_back(first);
+
+			for (int i = order.size() - 1; i < order.size(); i++) {
+				int face = order[i];
+
+				for (int e = adjacency->offsets[face]; e < adjacency->offsets[face + 1]; e++) {
+					int neighbor = adjacency->neighbors[e];
+
+					if (!seen[neighbor]) {
+						seen[neighbor] = true;
+						order.push_back(neighbor);
+					}
+				}
+			}
+		}
+
+		return order;
+	}
+
+	// find an edge that piece can hang from without overlapping the neighbor on the other side (the neighbors are tried in
+	// the order their edges are met and each one is laid out once), returns (face in piece, face in the neighbor)
+	static pair<int, int> findJoin(FaceAdjacency* adjacency, SpanningTree &forest, vector<int> &pieceOf, vector<vector<int>> &members, int piece) {
+		NetLayout layout(adjacency);
+		NetOverlap overlap(&layout);
+
+		vector<int> placedOrder;
+		vector<bool> tried(members.size(), false);
+		tried[piece] = true;
+
+		vector<int> &faces = members[piece];
+
+		for (int i = 0; i < faces.size(); i++) {
+			for (int e = adjacency->offsets[faces[i]]; e < adjacency->offsets[faces[i] + 1]; e++) {
+				int other = pieceOf[adjacency->neighbors[e]];
+
+				if (other == -1 || tried[other]) {
+					continue;
+				}
+				tried[other] = true;
+
+				// lay the neighbor out once and try every hinge between the two pieces against it
+				vector<int> &holders = members[other];
+
+				layout.clear();
+				overlap.clear();
+
+				layout.placeRoot(holders[0]);
+				overlap.insert(holders[0]);
+				for (int h = 1; h < holders.size(); h++) {
+					layout.placeFace(holders[h], forest.parent[holders[h]], forest.parentEdge[holders[h]]);
+					overlap.insert(holders[h]);
+				}
+
+				for (int j = i; j < faces.size(); j++) {
+					for (int f = adjacency->offsets[faces[j]]; f < adjacency->offsets[faces[j] + 1]; f++) {
+						int holder = adjacency->neighbors[f];
+
+						if (pieceOf[holder] != other) {
+							continue;
+						}
+
+						if (fits(adjacency, layout, overlap, forest, pieceOf, faces[j], holder, placedOrder)) {
+							return pair<int, int>(faces[j], holder);
+						}
+					}
+				}
+			}
+		}
+
+		return pair<int, int>(-1, -1);
+	}
+
+	// lay the piece of face out hanging from holder and check it against the faces in overlap (the piece is flat and does not
+	// overlap itself so only the neighbor has to be checked), the piece is taken back out of the layout afterwards
+	// (each hinge has an axis on both sides and walking up the piece folds about the other one so every fold is checked again)
+	static bool fits(FaceAdjacency* adjacency, NetLayout &layout, NetOverlap &overlap, SpanningTree &forest, vector<int> &pieceOf, int face, int holder, vector<int> &placedOrder) {
+		int edge = adjacency->findEdge(holder, face);
+		if (edge == -1 || !adjacency->hinged(edge)) {
+			return false;
+		}
+
+		// walk the tree of the piece outward from face (up through the parents as well as down)
+		placedOrder.clear();
+		placedOrder.push_back(face);
+		layout.placeFace(face, holder, edge);
+
+		bool clear = !overlap.overlapsAny(face);
+
+		for (int i = 0; i < placedOrder.size() && clear; i++) {
+			int current = placedOrder[i];
+
+			for (int e = adjacency->offsets[current]; e < adjacency->offsets[current + 1] && clear; e++) {
+				int next = adjacency->neighbors[e];
+
+				if (layout.placed[next] || pieceOf[next] != pieceOf[face]) {
+					continue;
+				}
+
+				if (forest.parent[next] != current && forest.parent[current] != next) {
+					continue;
+				}
+
+				if (!adjacency->hinged(e)) {
+					clear = false;
+					break;
+				}
+
+				layout.placeFace(next, current, e);
+				placedOrder.push_back(next);
+
+				clear = !overlap.overlapsAny(next);
+			}
+		}
+
+		for (int i = 0; i < placedOrder.size(); i++) {
+			layout.placed[placedOrder[i]] = false;
+		}
+
+		return clear;
+	}
+
+	// make face the root of its piece by turning the hinges between it and the old root around
+	static void reroot(FaceAdjacency* adjacency, SpanningTree &forest, int face) {
+		int child = face;
+		int parent = forest.parent[face];
+
+		forest.parent[face] = -1;
+		forest.parentEdge[face] = -1;
+
+		while (parent != -1) {
+			int next = forest.parent[parent];
+
+			forest.parent[parent] = child;
+			forest.parentEdge[parent] = adjacency->findEdge(child, parent);
+
+			child = parent;
+			parent = next;
+		}
+	}
+};
+
+#endif
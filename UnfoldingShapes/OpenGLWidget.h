@@ -20,6 +20,9 @@
 #include "Asset.h"
 #include "Model.h"
 #include "Mesh.h"
+#include "FaceTransformBuffer.h"
+#include "UniformBuffer.h"
+#include "RenderState.h"
 
 class OpenGLWidget : public QOpenGLWidget {
 public:
@@ -36,6 +39,17 @@ public:
 	Shader shader;
 	Shader testCubeShader;
 
+	// variant of shader that moves each face by its own transform
+	Shader hingedShader;
+	FaceTransformBuffer faceTransforms;
+
+	// texture unit for the face transforms (kept clear of the material textures)
+	const int faceTransformUnit = 8;
+
+	// camera and light data written once per frame and read by both model shaders
+	UniformBuffer<FrameUniforms> frameUniforms;
+	const unsigned int frameBinding = 0;
+
 	// light
 	Light light;
 
@@ -72,6 +86,9 @@ public:
 		format.setProfile(QSurfaceFormat::CoreProfile);
 		format.setSamples(samples);
 
+		// wait for the display's refresh when swapping so the frame loop runs at the refresh rate
+		format.setSwapInterval(1);
+
 		setFormat(format);
 	}
 
@@ -105,6 +122,14 @@ public:
 		// local shader
 		// shader = Shader("resources/shaders/basic_model.vs", "resources/shaders/basic_model.fs");
 		shader = Shader(f, "resources/shaders/lighted_model.vs", "resources/shaders/lighted_model.fs");
+
+		hingedShader = Shader(f, "resources/shaders/hinged_model.vs", "resources/shaders/lighted_model.fs");
+		hingedShader.setInt("faceTransforms", faceTransformUnit);
+		faceTransforms = FaceTransformBuffer(&f);
+
+		frameUniforms = UniformBuffer<FrameUniforms>(&f, frameBinding);
+		shader.bindUniformBlock("Frame", frameBinding);
+		hingedShader.bindUniformBlock("Frame", frameBinding);
 		
 		f->glClearColor(0.1f, 0.1f, 0.1f, 0.1f);
 
@@ -118,49 +143,60 @@ public:
 		// prep for render
 		f->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+		// qt and the loaders bind things on their own between frames
+		RenderState::invalidate();
+
 		//generateTestCube();
 		//drawTestCube(glm::vec3(0,0,4));
 		
 		// model rendering
-		shader.use();
-
-		// if the light is valid then enter lighting mode for shader
-		if (light.enabled) {
-			shader.setBool("enableLighting", true);
-
-			shader.setVec3("lightPos", light.pos);
-			shader.setVec3("lightColor", light.color);
-			shader.setFloat("lightBrightness", light.brightness);
-			shader.setFloat("lightDistance", light.distance);
-		}
+		// everything that is the same for all assets goes to the gpu once
+		updateFrameUniforms();
 
 		// draw assets with the corresponding model
 		// draw backwards since the board is transparent and the balls and other objects need to be drawn first
 		for (int i = scene.size() - 1; i >= 0; i--) {
 			if (scene[i]->visible) {
-				// camera stuff
+				// assets with mesh transforms are moved by the gpu
+				bool hinged = scene[i]->meshTransforms != nullptr && !scene[i]->meshTransforms->empty();
+				Shader &shader = hinged ? hingedShader : this->shader;
+
+				RenderState::use(f, shader);
 
-				glm::mat4 projection = camera.projection;
-				glm::mat4 view = camera.update();
-				shader.setMat4("projection", projection);
-				shader.setMat4("view", view);
-				shader.setVec3("viewPos", camera.pos);
+				if (hinged) {
+					faceTransforms.upload(*scene[i]->meshTransforms);
+					faceTransforms.bind(faceTransformUnit);
+				}
 
-				
 				// translate model
-				glm::mat4 model = glm::mat4(1.0f);
-				model = glm::translate(model, scene[i]->position);
-				model = glm::rotate(model, glm::radians(scene[i]->rotation.x), glm::vec3(1.0, 0.0, 0.0));
-				model = glm::rotate(model, glm::radians(scene[i]->rotation.y), glm::vec3(0.0, 1.0, 0.0));
-				model = glm::rotate(model, glm::radians(scene[i]->rotation.z), glm::vec3(0.0, 0.0, 1.0));
-				model = glm::scale(model, scene[i]->scale);	// it's a bit too big for our scene, so scale it down
-				shader.setMat4("model", model);
+				shader.setMat4("model", scene[i]->getModelMatrix());
 
 				if (scene[i]->model != nullptr) {
 					scene[i]->model->Draw(shader, camera);
 				}
 			}
 		}
+
+		// leave no vao bound for qt to change by accident
+		RenderState::bindVertexArray(f, 0);
+	}
+
+	// fill the frame block with the camera and, if the light is valid, enter lighting mode
+	void updateFrameUniforms() {
+		FrameUniforms frame;
+
+		frame.projection = camera.projection;
+		frame.view = camera.update();
+		frame.viewPos = glm::vec4(camera.pos, 1.0f);
+
+		frame.enableLighting = light.enabled;
+		frame.lightPos = glm::vec4(light.pos, 1.0f);
+		frame.lightColor = glm::vec4(light.color, 1.0f);
+		frame.lightBrightness = light.brightness;
+		frame.lightDistance = light.distance;
+		frame.padding = 0;
+
+		frameUniforms.upload(frame);
 	}
 
 	// set mouse event handling to update mouse struct
@@ -0,0 +1,105 @@
+#ifndef RENDERSTATE_H
+#define RENDERSTATE_H
+
+#include <QtWidgets/qopenglwidget.h>
+#include <QtGui/qopenglfunctions_3_3_core.h>
+
+#include <shader.h>
+
+#include "RenderStats.h"
+
+#include <iostream>
+
+// remembers the gl state last set through it so binds that would not change anything are never sent
+// only correct while every bind of the cached kinds goes through here, call invalidate() after code that binds on its own
+// (qt or anything drawn outside the widget) and at the start of every frame
+struct RenderState {
+	static constexpr int textureUnits = 16;
+
+	// nothing is known about the state
+	static constexpr unsigned int unknown = 0xFFFFFFFF;
+
+	inline static unsigned int program = unknown;
+	inline static unsigned int vertexArray = unknown;
+	inline static int activeUnit = -1;
+
+	// texture bound on each unit and the target it was bound to
+	inline static unsigned int textures[textureUnits];
+	inline static GLenum targets[textureUnits];
+
+	// the owner (eg: a mesh) of the material uniforms last set on program
+	inline static const void* material = nullptr;
+
+	static void invalidate() {
+		program = unknown;
+		vertexArray = unknown;
+		activeUnit = -1;
+
+		for (int i = 0; i < textureUnits; i++) {
+			textures[i] = unknown;
+			targets[i] = 0;
+		}
+
+		material = nullptr;
+	}
+
+	static void use(QOpenGLFunctions_3_3_Core* f, Shader &shader) {
+		if (program == shader.ID) {
+			RenderStats::skippedPrograms++;
+			return;
+		}
+
+		f->glUseProgram(shader.ID);
+		program = shader.ID;
+
+		// uniforms belong to the program so they have to be set again
+		material = nullptr;
+	}
+
+	static void bindVertexArray(QOpenGLFunctions_3_3_Core* f, unsigned int id) {
+		if (vertexArray == id) {
+			RenderStats::skippedVertexArrays++;
+			return;
+		}
+
+		f->glBindVertexArray(id);
+		vertexArray = id;
+	}
+
+	static void activeTexture(QOpenGLFunctions_3_3_Core* f, int unit) {
+		if (activeUnit == unit) {
+			return;
+		}
+
+		f->glActiveTexture(GL_TEXTURE0 + unit);
+		activeUnit = unit;
+	}
+
+	static void bindTexture(QOpenGLFunctions_3_3_Core* f, int unit, GLenum target, unsigned int id) {
+		if (unit < textureUnits && textures[unit] == id && targets[unit] == target) {
+			RenderStats::skippedTextures++;
+			return;
+		}
+
+		activeTexture(f, unit);
+		f->glBindTexture(target, id);
+
+		if (unit < textureUnits) {
+			textures[unit] = id;
+			targets[unit] = target;
+		}
+	}
+
+	// returns true if the material of owner still has to be set on the program in use (and records it as set)
+	static bool changeMaterial(const void* owner) {
+		if (material == owner) {
+			RenderStats::skippedMaterials++;
+			return false;
+		}
+
+		material = owner;
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include <iostream>
+
+// running totals of the gl work done while drawing (read and reset by whoever reports them)
+struct RenderStats {
+	inline static size_t drawCalls = 0;
+
+	// state changes RenderState did not send because the state was already set
+	inline static size_t skippedPrograms = 0;
+	inline static size_t skippedVertexArrays = 0;
+	inline static size_t skippedTextures = 0;
+	inline static size_t skippedMaterials = 0;
+
+	static size_t skipped() {
+		return skippedPrograms + skippedVertexArrays + skippedTextures + skippedMaterials;
+	}
+
+	static void reset() {
+		drawCalls = 0;
+
+		skippedPrograms = 0;
+		skippedVertexArrays = 0;
+		skippedTextures = 0;
+		skippedMaterials = 0;
+	}
+};
+
+#endif
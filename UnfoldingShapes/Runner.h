@@ -2,7 +2,6 @@
 #define RUNNER_H
 
 #include <QtCore/qobject.h>
-#include <QtCore/qtimer.h>
 
 #include "OpenGLWidget.h"
 #include "UnfoldingShapes.h"
@@ -17,7 +16,6 @@
 #include <chrono>
 #include <cmath>
 #include <ctime>
-#include <windows.h>
 
 // graphics tools
 #include "Camera.h"
@@ -77,16 +75,28 @@ public:
 
 	int samples = 16;
 
+	// unfold shapes in the vertex shader instead of moving their vertices every frame
+	bool gpuHinges = true;
+
 	// default
 	unsigned int SCR_WIDTH = 1600 * relativeScreenSize;
 	unsigned int SCR_HEIGHT = 900 * relativeScreenSize;
 
 	// fps info
 	bool fpsCounterEnabled = true;
-	const double fps = 60;
+
+	// seconds between fps reports
+	const double reportInterval = 1.0;
+
+	// longest step the animations take in one frame (so a stall does not skip most of an unfold)
+	const float maxFrameSeconds = 0.1f;
 
 	int fpsCount;
-	int fpsCounter;
+	long long updateMicroseconds = 0;
+
+	// start of the last frame and of the current fps report (monotonic so clock changes do not matter)
+	std::chrono::steady_clock::time_point lastFrame;
+	std::chrono::steady_clock::time_point lastReport;
 
 	// game
 	int gameState;
@@ -98,8 +108,6 @@ public:
 
 	Animator animator;
 
-	QTimer *timer;
-
 	Model* tableModel;
 	Asset* tableObj;
 
@@ -111,10 +119,9 @@ public:
 	}
 
 	void setup() {
-		// set timer for each frame to update
-		timer = new QTimer(this);
-		QObject::connect(timer, &QTimer::timeout, this, &Runner::frame);
-		timer->start(1000/fps);
+		// every frame starts when the last one reached the screen, so frames follow the display's refresh (vsync)
+		// instead of a timer and the gui thread never has to sleep
+		QObject::connect(graphics, &QOpenGLWidget::frameSwapped, this, &Runner::frame);
 
 		// add all static objects to the scene
 		tableModel = new Model(&(graphics->f), tablePath, graphics->samples);
@@ -136,7 +143,6 @@ public:
 
 		// setup shapes
 		shapes = new vector<Shape*>;
-		animator = Animator();
 
 		// set links and setup
 		ui->linkAnimator(&animator);
@@ -157,62 +163,63 @@ public:
 
 		// fps and game init
 		fpsCount = 0;
-		fpsCounter = 0;
+
+		lastFrame = std::chrono::steady_clock::now();
+		lastReport = lastFrame;
 
 		gameState = 1;
+
+		// start the frame loop
+		graphics->update();
 	}
 
 	void frame() {
-		//std::cout << "here" << std::endl;
-
 		// START timer
-		std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+		// animations move by the time that passed so they run at the same speed at any frame rate
+		float seconds = std::chrono::duration<float>(now - lastFrame).count();
+		lastFrame = now;
+
+		if (seconds > maxFrameSeconds) {
+			seconds = maxFrameSeconds;
+		}
 
 		// Main
 		// update controls
 		//updateControls(graphics->window, animator);
 
-		animator.update();
+		animator.update(seconds);
 
 		// update player position
 		//graphics->setText("position", "Position: " + glm::to_string(graphics->camera.pos));
 
-		// update renderer
+		// update renderer (the next frame starts when this one is swapped)
 		graphics->update();
 
-		// END of timer sleep and normalize the clock
-		std::chrono::system_clock::time_point after = std::chrono::system_clock::now();
-		std::chrono::microseconds difference(std::chrono::time_point_cast<std::chrono::microseconds>(after) - std::chrono::time_point_cast<std::chrono::microseconds>(now));
-
-		// count the fps
-		int diffCount = difference.count();
-		if (diffCount == 0) {
-			diffCount = 1;
-		}
-
-		int sleepDuration = ((1000000 / fps * 1000) - diffCount) / 1000000;
+		// END of timer
+		std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
 
 		// output fps
 		fpsCount += 1;
-		fpsCounter += 1000000 / diffCount;
+		updateMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(after - now).count();
 
-		if (fpsCount % int(fps) == 0) {
+		double reportSeconds = std::chrono::duration<double>(after - lastReport).count();
+
+		if (reportSeconds >= reportInterval) {
 			if (fpsCounterEnabled) {
-				std::cout << "\rFPS: " << fpsCounter / fpsCount;
+				// update time and gpu uploads are averaged over the frames since the last report
+				std::cout << "\rFPS: " << int(fpsCount / reportSeconds) << " | update: " << (updateMicroseconds / fpsCount) / 1000.0f << " ms | uploads: " << UploadStats::uploads / fpsCount << " (" << UploadStats::bytes / fpsCount / 1024 << " KB) per frame | draw calls: " << RenderStats::drawCalls / fpsCount << " (" << RenderStats::skipped() / fpsCount << " binds skipped) per frame    ";
 
 				// set text
-				//graphics->setText("fps", "FPS: " + std::to_string(int(fpsCounter / fpsCount)));
+				//graphics->setText("fps", "FPS: " + std::to_string(int(fpsCount / reportSeconds)));
 			}
 			fpsCount = 0;
-			fpsCounter = 0;
-		}
-
-		if (sleepDuration < 0) {
-			sleepDuration = 0;
+			updateMicroseconds = 0;
+			lastReport = after;
+			UploadStats::reset();
+			RenderStats::reset();
 		}
-
-		// std::cout << sleepDuration << std::endl;
-		Sleep(sleepDuration);
 	}
 
 	// shortcut for adding files
@@ -222,6 +229,8 @@ public:
 
 	// add shape to animator
 	void addShape(Shape* shape) {
+		shape->setGpuPose(gpuHinges);
+
 		shapes->push_back(shape);
 		graphics->addAsset((*shapes)[shapes->size() - 1]->asset);
 
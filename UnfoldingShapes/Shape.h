@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <vector>
+#include <unordered_map>
 
 // graphics tools
 #include "Camera.h"
@@ -19,6 +20,9 @@
 
 #include "Face.h"
 #include "Graph.h"
+#include "EdgeIndex.h"
+#include "FaceAdjacency.h"
+#include "NetLayout.h"
 
 #include "OpenGLWidget.h"
 
@@ -26,73 +30,31 @@ inline string getNameFromPath(string path);
 
 class Shape {
 public:
-	struct Transformation {
-		float deltaAngle;
-		Face::Axis axis;
-
-		vector<Face*> appliedFaces;
-
-		Transformation(float deltaAngle, Face::Axis* axis, Face* appliedFace) {
-			this->deltaAngle = deltaAngle;
-			this->axis = *axis;
-
-			// clear and add one
-			this->appliedFaces = vector<Face*>();
-			this->appliedFaces.push_back(appliedFace);
-		}
-
-		Transformation(float deltaAngle, Face::Axis* axis, vector<Face*> appliedFaces = vector<Face*>()) {
-			this->deltaAngle = deltaAngle;
-			this->axis = *axis;
-			this->appliedFaces = appliedFaces;
-		}
-
-		// apply the transformation
-		void apply() {
-			//std::cout << deltaAngle << std::endl;
-			for (int i = 0; i < appliedFaces.size(); i++) {
-				// rotate vertices
-				for (int j = 0; j < appliedFaces[i]->mesh->vertices.size(); j++) {
-					appliedFaces[i]->mesh->vertices[j].Position = axis.rotateAbout(appliedFaces[i]->mesh->vertices[j].Position, deltaAngle);
-				}
-
-				// rotate axis
-				for (int j = 0; j < appliedFaces[i]->axis.size(); j++) {
-					appliedFaces[i]->axis[j]->rotateAxisAbout(&axis, deltaAngle);
-				}
-			}
-		}
-
-		// revert the transformation
-		void revert() {
-			for (int i = 0; i < appliedFaces.size(); i++) {
-				// rotate vertices
-				for (int j = 0; j < appliedFaces[i]->mesh->vertices.size(); j++) {
-					//appliedFaces[i]->mesh->vertices[j].Position = appliedFaces[i]->mesh->backupVertices[j].Position;
-
-					appliedFaces[i]->mesh->vertices[j].Position = axis.rotateAbout(appliedFaces[i]->mesh->vertices[j].Position, -deltaAngle);
-					//std::cout << glm::to_string(appliedFaces[i]->mesh->vertices[j].Position) << std::endl;
-				}
-
-				// rotate axis
-				for (int j = 0; j < appliedFaces[i]->axis.size(); j++) {
-					appliedFaces[i]->axis[j]->rotateAxisAbout(&axis, -deltaAngle);
-					appliedFaces[i]->axis[j]->revert();
-				}
-			}
-		}
-	};
-
 	Asset* asset;
 	Model* model;
 	
 	vector<Face*> faces;
 	Graph<Face> faceMap;
 
-	Graph<Face>* unfold;
+	// compact copy of the faceMap for traversals (built once the faceMap is done)
+	FaceAdjacency faceAdjacency;
 
-	// stores the transformations applied to the shape so we can revert.
-	vector<Transformation> appliedTransformations;
+	// current solution (owned by the shape, replace it through setUnfold)
+	Graph<Face>* unfold = nullptr;
+
+	// spanning tree form of the current unfold (kept in sync by setUnfold)
+	SpanningTree unfoldTree;
+
+	// rest pose -> current pose of each face (same order as faces, empty while the shape is at rest)
+	// this is the pose being drawn, new poses are written to posedTransforms and swapped in by presentPose
+	vector<glm::mat4> faceTransforms;
+
+	// the next pose (filled by setPose, possibly on the animator's worker while faceTransforms is drawn)
+	vector<glm::mat4> posedTransforms;
+	bool posePending = false;
+
+	// when set the vertices never move, the face transforms are handed to the renderer and applied in the vertex shader
+	bool gpuPose = false;
 
 	string name;
 
@@ -109,6 +71,9 @@ public:
 
 		this->model = new Model(&(graphics->f), path, graphics->samples);
 		std::cout << "Meshes: " << this->model->meshes.size() << std::endl;
+
+		// one mesh per face would mean one draw call per face
+		this->model->enableBatching();
 		asset = new Asset(this->model, pos, rot, scale);
 
 		initFaces();
@@ -116,26 +81,123 @@ public:
 		std::cout << "finished loading: " << name << std::endl;
 	}
 
+	~Shape() {
+		delete unfold;
+		delete spareSolution;
+	}
+
+	// returns an empty graph to build a solution in (reuses the last replaced solution when there is one)
+	Graph<Face>* newSolution() {
+		if (spareSolution == nullptr) {
+			return new Graph<Face>();
+		}
+
+		Graph<Face>* solution = spareSolution;
+		spareSolution = nullptr;
+
+		return solution;
+	}
+
+	// takes ownership of newSolution, the previous solution is emptied and kept for the next newSolution call
 	void setUnfold(Graph<Face>* newSolution) {
 		revert();
 
+		if (unfold != nullptr && unfold != newSolution) {
+			unfold->reset();
+
+			delete spareSolution;
+			spareSolution = unfold;
+		}
+
 		unfold = newSolution;
-	}
 
-	// add transformation to the shape
-	void transform(float deltaAngle, Face::Axis* axis, vector<Face*> appliedFaces) {
-		appliedTransformations.push_back(Transformation(deltaAngle, axis, appliedFaces));
-		appliedTransformations[appliedTransformations.size() - 1].apply();
+		unfoldTree = faceAdjacency.treeFromGraph(unfold);
+		unfoldTree.buildChildren();
+		NetLayout::placePieces(&faceAdjacency, unfoldTree);
 	}
 
-	// undo transformations
+	// return the shape to its rest pose (right away, drops a pose that was not presented yet)
 	void revert() {
-		// revert transformations and clear list
-		for (int i = appliedTransformations.size() - 1; i >= 0; i--) {
-			appliedTransformations[i].revert();
+		if (faceTransforms.empty() && !posePending) {
+			return;
+		}
+
+		for (int i = 0; i < faces.size(); i++) {
+			vector<Vertex>* vertices = &faces[i]->mesh->vertices;
+			vector<Vertex>* backup = &faces[i]->mesh->backupVertices;
+
+			for (int j = 0; j < vertices->size() && !gpuPose; j++) {
+				(*vertices)[j].Position = (*backup)[j].Position;
+			}
+
+			for (int j = 0; j < faces[i]->axis.size(); j++) {
+				faces[i]->axis[j]->revert();
+			}
+		}
+
+		faceTransforms.clear();
+		posedTransforms.clear();
+		posePending = false;
+	}
+
+	// switch between moving the vertices on the cpu and handing the face transforms to the gpu
+	void setGpuPose(bool enabled) {
+		revert();
+
+		gpuPose = enabled;
+		asset->meshTransforms = enabled ? &faceTransforms : nullptr;
+
+		// a batched model already tags every vertex with its mesh index, the per mesh ids are only read when drawing mesh by mesh
+		for (int i = 0; i < faces.size() && enabled && model->batch == nullptr; i++) {
+			if (faces[i]->mesh->faceId != i) {
+				faces[i]->mesh->setFaceId(i);
+			}
+		}
+
+		// face normals for the rest pose (the shader turns them with the faces)
+		model->rebuildMeshes();
+	}
+
+	// move every face by its own transform from the rest pose (one transform per face, same order as faces)
+	// each vertex is written straight from backupVertices so the pose never depends on the one before it
+	// (with gpuPose only the transforms are kept and the vertex shader does the rest)
+	// the pose is shown after presentPose, only touches the cpu side so it can run off the gl thread
+	void setPose(vector<glm::mat4> &transforms) {
+		for (int i = 0; i < faces.size() && i < transforms.size(); i++) {
+			glm::mat4 transform = transforms[i];
+			glm::mat3 rotation = glm::mat3(transform);
+
+			vector<Vertex>* vertices = &faces[i]->mesh->vertices;
+			vector<Vertex>* backup = &faces[i]->mesh->backupVertices;
+
+			for (int j = 0; j < vertices->size() && !gpuPose; j++) {
+				(*vertices)[j].Position = glm::vec3(transform * glm::vec4((*backup)[j].Position, 1.0f));
+			}
+
+			// keep the axis where the face is so they still describe its edges
+			for (int j = 0; j < faces[i]->axis.size(); j++) {
+				Face::Axis* axis = faces[i]->axis[j];
+
+				axis->point = glm::vec3(transform * glm::vec4(axis->originalPoint, 1.0f));
+				axis->line = glm::normalize(rotation * axis->originalLine);
+			}
+		}
+
+		posedTransforms = transforms;
+		posePending = true;
+	}
 
-			appliedTransformations.erase(appliedTransformations.begin() + i);
+	// make the last pose from setPose the one that is drawn, returns false if there was none
+	// (call on the gl thread, cpu posed shapes still have to upload their meshes after)
+	bool presentPose() {
+		if (!posePending) {
+			return false;
 		}
+
+		faceTransforms.swap(posedTransforms);
+		posePending = false;
+
+		return true;
 	}
 
 	// returns the local position of the base
@@ -148,44 +210,122 @@ public:
 	}
 
 private:
-	// recursivley populate the faceMap
-	void populateFaceMap(Graph<Face>::Node* node, vector<Face*> &faces) {
-		vector<Face*> tempFaces = vector<Face*>();
+	// emptied solution waiting to be reused
+	Graph<Face>* spareSolution = nullptr;
+
+	// pair up the shared axis of all the faces and build the faceMap outward from the root
+	// every axis is hashed by its end points once so matching takes one pass over all axis instead of comparing every pair
+	// axis that share no end points are still paired when they lie on the same line and overlap along it
+	// the map is grown breadth first with a queue so deep meshes cannot overflow the stack
+	void populateFaceMap(Face* root) {
+		// index of each face in the faces list
+		unordered_map<Face*, int> faceIndex;
+		faceIndex.reserve(faces.size());
 
-		// std::cout << "faces size: " << faces.size() << std::endl;
 		for (int i = 0; i < faces.size(); i++) {
-			for (int g = 0; g < faces[i]->axis.size(); g++) {
-				for (int h = 0; h < node->data->axis.size(); h++) {
-					//std::cout << glm::to_string(node->data->axis[g]->line) << " " << glm::to_string(node->data->axis[g]->point) << std::endl;
-					//std::cout << glm::to_string(node->data->axis[g]->line) << " " << glm::to_string(node->data->axis[g]->point) << std::endl << std::endl;
-					
-					// if the axis match and they are not the same face
-					if (*faces[i]->axis[g] == *node->data->axis[h] && node->data != faces[i]) {
-						// set neighbors of each axis for pairing
-						faces[i]->axis[g]->setNeighbor(node->data, node->data->axis[h]);
-						node->data->axis[h]->setNeighbor(faces[i], faces[i]->axis[g]);
-
-						tempFaces.push_back(faces[i]);
-					}
+			faceIndex[faces[i]] = i;
+		}
+
+		// axis end points -> every axis along that edge (axis are numbered in the order of the faces)
+		EdgeIndex axisIndex(Face::Axis::marginOfError);
+		vector<Face*> axisFace;
+		vector<Face::Axis*> axisList;
+
+		for (int i = 0; i < faces.size(); i++) {
+			for (int j = 0; j < faces[i]->axis.size(); j++) {
+				axisIndex.add(faces[i]->axis[j]->p1, faces[i]->axis[j]->p2, axisList.size());
+
+				axisFace.push_back(faces[i]);
+				axisList.push_back(faces[i]->axis[j]);
+			}
+		}
+
+		// set neighbors of each axis for pairing and remember which faces touch
+		vector<vector<int>> neighbors(faces.size());
+
+		auto pairAxis = [&](int a, int b) {
+			Face* face1 = axisFace[a];
+			Face* face2 = axisFace[b];
+
+			// two edges of the same face never hinge
+			if (face1 == face2) {
+				return;
+			}
+
+			axisList[a]->setNeighbor(face2, axisList[b]);
+			axisList[b]->setNeighbor(face1, axisList[a]);
+
+			neighbors[faceIndex[face1]].push_back(faceIndex[face2]);
+			neighbors[faceIndex[face2]].push_back(faceIndex[face1]);
+		};
+
+		for (auto &edge : axisIndex.edges) {
+			vector<unsigned int> &shared = edge.second;
+
+			for (int i = 0; i < shared.size(); i++) {
+				for (int j = i + 1; j < shared.size(); j++) {
+					pairAxis(shared[i], shared[j]);
 				}
 			}
 		}
 
-		// std::cout << tempFaces.size() << std::endl;
+		// edges that only partly line up (like a T junction where one long edge meets two short ones) do not share end points
+		// so the axis left over are matched again by the line they lie on and paired where their segments overlap
+		// (collinear edges that do not overlap are not paired, they never touch)
+		EdgeIndex lineIndex(Face::Axis::marginOfError);
+
+		for (int i = 0; i < axisList.size(); i++) {
+			if (axisList[i]->sharedAxis == nullptr) {
+				// both directions of the line give the same two points
+				glm::vec3 point = axisList[i]->originalPoint;
+				glm::vec3 line = axisList[i]->originalLine;
 
-		// add all children and proccess them too
-		// std::cout << "tempFaces size: " << tempFaces.size() << std::endl;
-		for (int i = 0; i < tempFaces.size(); i++) {
-			// this prevents the recursive method from getting stuck in a loop (only run populateFaceMap once for each face)
-			bool exists = false;
-			if (node->graph->findNode(node->graph->rootNode, tempFaces[i]) != nullptr) {
-				exists = true;
+				lineIndex.add(point + line, point - line, i);
 			}
+		}
+
+		for (auto &edge : lineIndex.edges) {
+			vector<unsigned int> &shared = edge.second;
+
+			for (int i = 0; i < shared.size(); i++) {
+				Face::Axis* axis1 = axisList[shared[i]];
 
-			Graph<Face>::Node* newNode = node->graph->newNode(node, tempFaces[i], true);
+				for (int j = i + 1; j < shared.size(); j++) {
+					Face::Axis* axis2 = axisList[shared[j]];
 
-			if (exists == false) {
-				populateFaceMap(newNode, faces);
+					// span of each edge along the line
+					float a1 = glm::dot(axis1->p1, axis1->originalLine);
+					float a2 = glm::dot(axis1->p2, axis1->originalLine);
+					float b1 = glm::dot(axis2->p1, axis1->originalLine);
+					float b2 = glm::dot(axis2->p2, axis1->originalLine);
+
+					if (min(max(a1, a2), max(b1, b2)) - max(min(a1, a2), min(b1, b2)) > Face::Axis::marginOfError) {
+						pairAxis(shared[i], shared[j]);
+					}
+				}
+			}
+		}
+
+		// breadth first from the root connecting every face with its neighbors
+		vector<Graph<Face>::Node*> nodes(faces.size(), nullptr);
+		vector<int> queue;
+
+		nodes[faceIndex[root]] = faceMap.newRootNode(root);
+		queue.push_back(faceIndex[root]);
+
+		for (int q = 0; q < queue.size(); q++) {
+			int current = queue[q];
+
+			for (int i = 0; i < neighbors[current].size(); i++) {
+				int neighbor = neighbors[current][i];
+
+				Graph<Face>::Node* newNode = faceMap.newNode(nodes[current], faces[neighbor], true);
+
+				// only process each face once
+				if (nodes[neighbor] == nullptr) {
+					nodes[neighbor] = newNode;
+					queue.push_back(neighbor);
+				}
 			}
 		}
 	}
@@ -194,42 +334,21 @@ private:
 	void initAxisInfo() {
 		// use the facemap to assign original angles to each of the faces
 		for (int i = 0; i < faces.size(); i++) {
-			Graph<Face>::Node* current = faceMap.findNode(faceMap.rootNode, faces[i]);
+			Graph<Face>::Node* current = faceMap.findNode(faces[i]);
 
 			if (current != nullptr) {
-				// search through all of the nodes and find the angles between them and their connections.
-				for (int j = 0; j < current->connections.size(); j++) {
-					for (int h = 0; h < current->data->axis.size(); h++) {
-						// make sure the axis is valid and has a neighbor
-						if (current->data->axis[h]->sharedAxis != nullptr) {
-							// identify leftover points to compare to find the angle
-							glm::vec3 vertex1 = current->data->mesh->getAvgPos();
-							glm::vec3 vertex2 = current->data->axis[h]->neighborFace->mesh->getAvgPos();
-
-							/*
-							for (int k = 0; k < current->data->mesh->indices.size(); k++) {
-								// if point is not on axis
-								vertex1 = current->data->mesh->vertices[current->data->mesh->indices[k]].Position;
-								if (current->data->axis[h]->hasPoint(vertex1) == false) {
-									break;
-								}
-							}
-
-							for (int k = 0; k < current->data->axis[h]->neighborFace->mesh->indices.size(); k++) {
-								// if point is not on axis
-								vertex2 = current->data->axis[h]->neighborFace->mesh->vertices[current->data->axis[h]->neighborFace->mesh->indices[k]].Position;
-								if (current->data->axis[h]->sharedAxis->hasPoint(vertex2) == false) {
-									break;
-								}
-							}
-
-							*/
-
-							// set axis original angle.
-							float angle = current->data->axis[h]->orientedAngle(vertex1, vertex2);
-							current->data->axis[h]->originalAngle = angle;
-							// current->data->axis[h]-sharedAxis->originalAngle = angle;
-						}
+				// find the angles between the face and its connections.
+				for (int h = 0; h < current->data->axis.size(); h++) {
+					// make sure the axis is valid and has a neighbor
+					if (current->data->axis[h]->sharedAxis != nullptr) {
+						// identify leftover points to compare to find the angle
+						glm::vec3 vertex1 = current->data->mesh->getAvgPos();
+						glm::vec3 vertex2 = current->data->axis[h]->neighborFace->mesh->getAvgPos();
+
+						// set axis original angle.
+						float angle = current->data->axis[h]->orientedAngle(vertex1, vertex2);
+						current->data->axis[h]->originalAngle = angle;
+						// current->data->axis[h]-sharedAxis->originalAngle = angle;
 					}
 				}
 			}
@@ -277,7 +396,12 @@ private:
 		Face* largest = faces[0];
 
 		for (int i = 1; i < faces.size(); i++) {
-			if (faces[i]->mesh->getAvgPos().y < largest->mesh->getAvgPos().y) {
+			// a face with no axis (like a collapsed triangle at the pole of a uv sphere) can not hold the rest of the shape
+			if (faces[i]->axis.empty()) {
+				continue;
+			}
+
+			if (largest->axis.empty() || faces[i]->mesh->getAvgPos().y < largest->mesh->getAvgPos().y) {
 				largest = faces[i];
 			}
 		}
@@ -295,10 +419,11 @@ private:
 		//levelBase();
 
 		// make the faceMap
-		faceMap = Graph<Face>(largest);
-		populateFaceMap(faceMap.rootNode, faces);
+		populateFaceMap(largest);
 
 		initAxisInfo();
+
+		faceAdjacency = FaceAdjacency(faceMap, faces);
 	}
 };
 
@@ -0,0 +1,99 @@
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <QtWidgets/qopenglwidget.h>
+#include <QtGui/qopenglfunctions_3_3_core.h>
+
+#include <iostream>
+#include <cstring>
+
+// running totals of the data streamed to the gpu (read and reset by whoever reports them)
+struct UploadStats {
+	inline static size_t bytes = 0;
+	inline static size_t uploads = 0;
+
+	static void reset() {
+		bytes = 0;
+		uploads = 0;
+	}
+};
+
+// gpu buffer for data that is replaced every frame
+// the storage is split into a ring of regions and every upload goes into the next one, so the gpu can still be drawing from
+// the last frames while the new one is written (no stall waiting for it to finish). the whole buffer is orphaned each time the
+// ring wraps around so a region is never overwritten while a draw could still be reading it.
+class StreamBuffer {
+public:
+	StreamBuffer() {
+
+	}
+
+	StreamBuffer(QOpenGLFunctions_3_3_Core **f, GLenum target = GL_ARRAY_BUFFER, int regions = 3) {
+		this->f = f;
+		this->target = target;
+		this->regions = regions;
+
+		(*f)->glGenBuffers(1, &buffer);
+	}
+
+	void destroy() {
+		(*f)->glDeleteBuffers(1, &buffer);
+		buffer = 0;
+	}
+
+	unsigned int id() {
+		return buffer;
+	}
+
+	// copy data into the next region and return the byte offset it was written to (leaves the buffer bound to the target)
+	size_t upload(const void* data, size_t bytes) {
+		(*f)->glBindBuffer(target, buffer);
+
+		if (bytes > regionSize) {
+			// grow and start the ring over
+			regionSize = bytes;
+			region = 0;
+
+			(*f)->glBufferData(target, regionSize * regions, nullptr, GL_STREAM_DRAW);
+		}
+		else {
+			region = (region + 1) % regions;
+
+			if (region == 0) {
+				(*f)->glBufferData(target, regionSize * regions, nullptr, GL_STREAM_DRAW);
+			}
+		}
+
+		size_t offset = region * regionSize;
+
+		// this region is not in use by any pending draw so there is nothing to synchronize with
+		void* mapped = (*f)->glMapBufferRange(target, offset, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+		if (mapped != nullptr) {
+			memcpy(mapped, data, bytes);
+			(*f)->glUnmapBuffer(target);
+		}
+		else {
+			(*f)->glBufferSubData(target, offset, bytes, data);
+		}
+
+		UploadStats::bytes += bytes;
+		UploadStats::uploads++;
+
+		return offset;
+	}
+
+private:
+	QOpenGLFunctions_3_3_Core **f;
+
+	unsigned int buffer = 0;
+	GLenum target = GL_ARRAY_BUFFER;
+
+	int regions = 3;
+	int region = 0;
+
+	// bytes in each region of the ring
+	size_t regionSize = 0;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+using namespace std;
+
+// threads kept waiting for loops to split between them
+// the items of a loop are handed out one at a time from a shared counter so a thread that finishes early just takes the
+// next item (uneven items like shapes of very different sizes still keep every thread busy)
+class ThreadPool {
+public:
+	// threads = 0 uses every core (the thread calling parallelFor counts as one of them)
+	ThreadPool(int threads = 0) {
+		if (threads <= 0) {
+			threads = max(1, (int)thread::hardware_concurrency());
+		}
+
+		for (int i = 0; i < threads - 1; i++) {
+			workers.push_back(thread(&ThreadPool::loop, this));
+		}
+	}
+
+	~ThreadPool() {
+		{
+			lock_guard<mutex> lock(poolLock);
+			stopping = true;
+		}
+		wake.notify_all();
+
+		for (int i = 0; i < workers.size(); i++) {
+			workers[i].join();
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// threads working on each loop including the caller
+	int size() {
+		return workers.size() + 1;
+	}
+
+	// run body(i) for every i in 0 to count - 1 across the pool and return once all of them are done
+	// (one loop at a time, the body must not call parallelFor itself)
+	void parallelFor(int count, const function<void(int)> &body) {
+		if (count <= 0) {
+			return;
+		}
+
+		// not worth waking anyone
+		if (workers.empty() || count == 1) {
+			for (int i = 0; i < count; i++) {
+				body(i);
+			}
+			return;
+		}
+
+		{
+			lock_guard<mutex> lock(poolLock);
+
+			this->body = &body;
+			this->count = count;
+			next = 0;
+			active = workers.size();
+			generation++;
+		}
+		wake.notify_all();
+
+		drain();
+
+		unique_lock<mutex> lock(poolLock);
+		done.wait(lock, [this]() { return active == 0; });
+
+		this->body = nullptr;
+	}
+
+private:
+	vector<thread> workers;
+
+	mutex poolLock;
+	condition_variable wake;
+	condition_variable done;
+
+	// current loop
+	const function<void(int)>* body = nullptr;
+	int count = 0;
+	atomic<int> next{ 0 };
+
+	// workers still inside the current loop
+	int active = 0;
+
+	// counts the loops so a worker knows when there is a new one
+	unsigned int generation = 0;
+	bool stopping = false;
+
+	void loop() {
+		unsigned int seen = 0;
+
+		while (true) {
+			{
+				unique_lock<mutex> lock(poolLock);
+				wake.wait(lock, [&]() { return stopping || generation != seen; });
+
+				if (stopping) {
+					return;
+				}
+
+				seen = generation;
+			}
+
+			drain();
+
+			{
+				lock_guard<mutex> lock(poolLock);
+				active--;
+			}
+			done.notify_all();
+		}
+	}
+
+	// take items until there are none left
+	void drain() {
+		int i;
+		while ((i = next.fetch_add(1)) < count) {
+			(*body)(i);
+		}
+	}
+};
+
+#endif
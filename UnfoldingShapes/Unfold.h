@@ -8,6 +8,12 @@
 
 #include <iostream>
 #include <vector>
+#include <chrono>
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <cfloat>
+#include <random>
 
 #include "Model.h"
 #include "Mesh.h"
@@ -17,384 +23,572 @@
 #include "Shape.h"
 
 #include "UnfoldSolution.h"
-
-//prototypes
-template<class RandomIt>
-void random_shuffle(RandomIt first, RandomIt last);
+#include "FaceAdjacency.h"
+#include "DisjointSet.h"
+#include "NetLayout.h"
+#include "NetSearch.h"
+#include "NetSegmentation.h"
+#include "NetOverlap.h"
+#include "NetScore.h"
+#include "ThreadPool.h"
 
 // computes unfold solutions
 static class Unfold {
 private:
-	static void basicRecusivePopulation(Graph<Face>::Node* mapNode, Graph<Face>* solution, Graph<Face>::Node* parent) {
-		for (int i = 0; i < mapNode->connections.size(); i++) {
-			if (solution->findNode(solution->rootNode, mapNode->connections[i]->data) == nullptr) {
-				// set new parent
-				parent = solution->newNode(parent, mapNode->connections[i]->data);
-				
-				// recursive
-				basicRecusivePopulation(mapNode->connections[i], solution, parent);
-			}
-		}
+	// random engine of the calling thread (seeded once per thread so parallel callers never share or repeat a sequence)
+	static mt19937 &threadRandom() {
+		thread_local mt19937 random(random_device{}());
+		return random;
 	}
 
-	static void randomBasicRecusivePopulation(Graph<Face>::Node* mapNode, Graph<Face>* solution, Graph<Face>::Node* parent) {
-		// randomly shuffle the connections order
-		vector<Graph<Face>::Node*> randConnections = mapNode->connections;
-		random_shuffle(randConnections.begin(), randConnections.end());
+	// order in which each face visits its edges (the edges of face i sit between offsets[i] and offsets[i + 1])
+	// shuffled with random if given, otherwise in the order of the adjacency
+	static vector<int> edgeOrder(FaceAdjacency* adjacency, mt19937* random) {
+		vector<int> edges(adjacency->edgeCount());
 
-		for (int i = 0; i < randConnections.size(); i++) {
-			if (solution->findNode(solution->rootNode, randConnections[i]->data) == nullptr) {
-				// set new parent
-				parent = solution->newNode(parent, randConnections[i]->data);
+		for (int e = 0; e < edges.size(); e++) {
+			edges[e] = e;
+		}
 
-				// recursive
-				basicRecusivePopulation(randConnections[i], solution, parent);
+		if (random != nullptr) {
+			for (int i = 0; i < adjacency->faceCount(); i++) {
+				std::shuffle(edges.begin() + adjacency->offsets[i], edges.begin() + adjacency->offsets[i + 1], *random);
 			}
 		}
+
+		return edges;
 	}
 
-	static void breadthPopulation(Graph<Face>::Node* root, Graph<Face>* solution) {
-		vector<Graph<Face>::Node*> queue;
-		vector<Graph<Face>::Node*> visited;
+	// depth first spanning tree of the adjacency (uses a stack instead of recursion so deep meshes cannot overflow)
+	static void depthPopulation(FaceAdjacency* adjacency, SpanningTree &tree, mt19937* random) {
+		tree.reset(adjacency->faceCount());
 
-		queue.push_back(root);
-		visited.push_back(root);
+		vector<int> edges = edgeOrder(adjacency, random);
+		vector<bool> visited(adjacency->faceCount(), false);
 
-		Graph<Face>::Node* current;
+		// stack of faces and the position of the next edge each one will try
+		vector<int> stack;
+		vector<int> cursor(adjacency->faceCount(), 0);
 
-		while (!queue.empty()) {
-			current = queue[0];
-			queue.erase(queue.begin());
+		stack.push_back(adjacency->root);
+		visited[adjacency->root] = true;
+		tree.order.push_back(adjacency->root);
+		cursor[adjacency->root] = adjacency->offsets[adjacency->root];
 
-			//std::cout << "New Animation Frame:" << std::endl;
+		while (!stack.empty()) {
+			int current = stack.back();
 
-			Graph<Face>::Node* currentSolutionNode = solution->findNode(solution->rootNode, current->data);
-			for (int i = 0; i < current->connections.size(); i++) {
-				bool inList = false;
+			// all neighbors visited so step back up
+			if (cursor[current] == adjacency->offsets[current + 1]) {
+				stack.pop_back();
+				continue;
+			}
 
-				for (int x = 0; x < visited.size(); x++) {
-					if (visited[x] == current->connections[i]) {
-						inList = true;
-						break;
-					}
-				}
+			int edge = edges[cursor[current]++];
+			int neighbor = adjacency->neighbors[edge];
 
-				if (!inList) {
-					solution->newNode(currentSolutionNode, current->connections[i]->data);
+			if (!visited[neighbor]) {
+				visited[neighbor] = true;
 
-					visited.push_back(current->connections[i]);
-					queue.push_back(current->connections[i]);
-				}
+				tree.parent[neighbor] = current;
+				tree.parentEdge[neighbor] = edge;
+				tree.order.push_back(neighbor);
+
+				cursor[neighbor] = adjacency->offsets[neighbor];
+				stack.push_back(neighbor);
 			}
 		}
 	}
 
-	static void randomBreadthPopulation(Graph<Face>::Node* root, Graph<Face>* solution) {
-		vector<Graph<Face>::Node*> queue;
-		vector<Graph<Face>::Node*> visited;
+	static void breadthPopulation(FaceAdjacency* adjacency, SpanningTree &tree, mt19937* random) {
+		tree.reset(adjacency->faceCount());
 
-		queue.push_back(root);
-		visited.push_back(root);
+		vector<int> edges = edgeOrder(adjacency, random);
+		vector<bool> visited(adjacency->faceCount(), false);
 
-		Graph<Face>::Node* current;
+		// the order doubles as the queue
+		visited[adjacency->root] = true;
+		tree.order.push_back(adjacency->root);
 
-		while (!queue.empty()) {
-			current = queue[0];
-			queue.erase(queue.begin());
-
-			Graph<Face>::Node* currentSolutionNode = solution->findNode(solution->rootNode, current->data);
+		for (int q = 0; q < tree.order.size(); q++) {
+			int current = tree.order[q];
 
-			// randomly shuffle the connections order
-			vector<Graph<Face>::Node*> randConnections = current->connections;
-			random_shuffle(randConnections.begin(), randConnections.end());
+			for (int i = adjacency->offsets[current]; i < adjacency->offsets[current + 1]; i++) {
+				int edge = edges[i];
+				int neighbor = adjacency->neighbors[edge];
 
-			for (int i = 0; i < randConnections.size(); i++) {
-				bool inList = false;
+				if (!visited[neighbor]) {
+					visited[neighbor] = true;
 
-				for (int x = 0; x < visited.size(); x++) {
-					if (visited[x] == randConnections[i]) {
-						inList = true;
-						break;
-					}
+					tree.parent[neighbor] = current;
+					tree.parentEdge[neighbor] = edge;
+					tree.order.push_back(neighbor);
 				}
+			}
+		}
+	}
 
-				if (!inList) {
-					solution->newNode(currentSolutionNode, randConnections[i]->data);
+	// direction the steepness of an edge is measured against
+	// (mostly up but not along an axis so the edges of boxes and prisms do not all tie)
+	static glm::vec3 steepnessDirection() {
+		return glm::normalize(glm::vec3(0.1f, 1.0f, 0.2f));
+	}
 
-					visited.push_back(randConnections[i]);
-					queue.push_back(randConnections[i]);
+	// weight of every adjacency edge from the geometry of its hinge
+	// steepness is how closely the edge follows steepnessDirection (0 level, 1 straight up), flip turns it into flatness
+	// hinges that fold less (smaller originalAngle) weigh a little less so they win the ties
+	// edges without a hinge always weigh the most
+	static vector<float> hingeWeights(FaceAdjacency* adjacency, bool flip) {
+		glm::vec3 direction = steepnessDirection();
+		vector<float> weights(adjacency->edgeCount(), 0.0f);
+
+		for (int face = 0; face < adjacency->faceCount(); face++) {
+			for (int e = adjacency->offsets[face]; e < adjacency->offsets[face + 1]; e++) {
+				Face::Axis* axis = adjacency->hinge(face, e);
+
+				if (axis == nullptr) {
+					weights[e] = 2.0f;
+					continue;
 				}
+
+				float steepness = abs(glm::dot(axis->originalLine, direction));
+				float fold = abs(axis->originalAngle) / 3.1415926535f;
+
+				weights[e] = (flip ? 1.0f - steepness : steepness) + 0.01f * fold;
 			}
 		}
+
+		return weights;
 	}
 
-public:
-	static Graph<Face>* basic(Shape* shape) {
-		// init solution with the base 
-		// std::cout << shape->faceMap.rootNode << std::endl;
+	// minimum spanning tree of the adjacency for weights[edge] (Kruskal)
+	// the edges are sorted once and joined with a DisjointSet so it runs in O(E log E), then the tree is hung from the root
+	static void weightedPopulation(FaceAdjacency* adjacency, SpanningTree &tree, vector<float> &weights) {
+		tree.reset(adjacency->faceCount());
 
-		Graph<Face>* solution = new Graph<Face>(shape->faceMap.rootNode->data);
+		vector<int> edges(adjacency->edgeCount());
+		for (int e = 0; e < edges.size(); e++) {
+			edges[e] = e;
+		}
 
-		basicRecusivePopulation(shape->faceMap.rootNode, solution, solution->rootNode);
+		std::sort(edges.begin(), edges.end(), [&](int a, int b) {
+			return weights[a] < weights[b];
+		});
 
-		return solution;
-	}
+		// face each edge starts from
+		vector<int> edgeFace(adjacency->edgeCount());
+		for (int face = 0; face < adjacency->faceCount(); face++) {
+			for (int e = adjacency->offsets[face]; e < adjacency->offsets[face + 1]; e++) {
+				edgeFace[e] = face;
+			}
+		}
 
-	static Graph<Face>* randomBasic(Shape* shape) {
-		// init solution with the base 
-		// std::cout << shape->faceMap.rootNode << std::endl;
+		// every hinge is listed from both of its faces so both directions are marked once it is taken
+		DisjointSet sets(adjacency->faceCount());
+		vector<bool> taken(adjacency->edgeCount(), false);
 
-		Graph<Face>* solution = new Graph<Face>(shape->faceMap.rootNode->data);
+		for (int i = 0; i < edges.size() && sets.count() > 1; i++) {
+			int edge = edges[i];
+			int face = edgeFace[edge];
+			int neighbor = adjacency->neighbors[edge];
 
-		randomBasicRecusivePopulation(shape->faceMap.rootNode, solution, solution->rootNode);
+			if (sets.join(face, neighbor)) {
+				taken[edge] = true;
 
-		return solution;
-	}
+				int back = adjacency->findEdge(neighbor, face);
+				if (back != -1) {
+					taken[back] = true;
+				}
+			}
+		}
 
-	static Graph<Face>* breadthUnfold(Shape* shape) {
-		// init solution with the base 
-		// std::cout << shape->faceMap.rootNode << std::endl;
+		// hang the tree from the root (the order doubles as the queue)
+		vector<bool> visited(adjacency->faceCount(), false);
+		visited[adjacency->root] = true;
+		tree.order.push_back(adjacency->root);
 
-		Graph<Face>* solution = new Graph<Face>(shape->faceMap.rootNode->data);
+		for (int q = 0; q < tree.order.size(); q++) {
+			int current = tree.order[q];
 
-		breadthPopulation(shape->faceMap.rootNode, solution);
+			for (int e = adjacency->offsets[current]; e < adjacency->offsets[current + 1]; e++) {
+				int neighbor = adjacency->neighbors[e];
 
-		// std::cout << solution->size << std::endl;
+				if (taken[e] && !visited[neighbor]) {
+					visited[neighbor] = true;
 
-		return solution;
+					tree.parent[neighbor] = current;
+					tree.parentEdge[neighbor] = e;
+					tree.order.push_back(neighbor);
+				}
+			}
+		}
 	}
 
-	static Graph<Face>* randomBreadthUnfold(Shape* shape) {
-		// init solution with the base 
-		// std::cout << shape->faceMap.rootNode << std::endl;
+	// shortest path tree from the root (Dijkstra) where crossing an edge costs the walk from one face's center to the middle of
+	// the hinge and on to the other face's center, O(E log E) with a binary heap
+	static void shortestPathPopulation(FaceAdjacency* adjacency, SpanningTree &tree) {
+		tree.reset(adjacency->faceCount());
+
+		// centers of the faces in the rest pose
+		vector<glm::vec3> centers(adjacency->faceCount(), glm::vec3(0));
+		for (int face = 0; face < adjacency->faceCount(); face++) {
+			vector<Vertex>* vertices = &adjacency->faces[face]->mesh->backupVertices;
 
-		Graph<Face>* solution = new Graph<Face>(shape->faceMap.rootNode->data);
+			for (int i = 0; i < vertices->size(); i++) {
+				centers[face] += (*vertices)[i].Position;
+			}
+			if (!vertices->empty()) {
+				centers[face] /= (float)vertices->size();
+			}
+		}
 
-		randomBreadthPopulation(shape->faceMap.rootNode, solution);
+		vector<float> distance(adjacency->faceCount(), FLT_MAX);
+		vector<bool> done(adjacency->faceCount(), false);
 
-		// std::cout << solution->size << std::endl;
+		// (distance, face) with the closest on top
+		priority_queue<pair<float, int>, vector<pair<float, int>>, greater<pair<float, int>>> queue;
 
-		return solution;
-	}
+		distance[adjacency->root] = 0;
+		queue.push({ 0.0f, adjacency->root });
 
-	// returns the minimum and maximum corners of an unfold on a flat plane (returns "0,0 0,0" if there are no vertices)
-	// Shape must have an unfold Assigned!
-	// Assumes that the shape is rotated so the root unfold node is perfectly aligned with the xz plane
-	static std::tuple<glm::vec2, glm::vec2> findUnfoldSize(Shape* shape) {
-		// find the position of each vertex in the unraveled 
-		float minx = 0;
-		float miny = 0;
-		float maxx = 0;
-		float maxy = 0;
+		while (!queue.empty()) {
+			int current = queue.top().second;
+			queue.pop();
 
-		// unwrap the shape to measure
-		if (shape->unfold == nullptr) {
-			return std::make_tuple(glm::vec2(0), glm::vec2(0));
-		}
+			// stale entry from before the face got closer
+			if (done[current]) {
+				continue;
+			}
+			done[current] = true;
 
-		// must ensure that the shape is normalized before calculations (reverted-see shape transformation struct)
-		shape->revert();
-		breadthFirstUpdate(shape, shape->unfold, 1.0);
+			// faces come off the queue in order of distance so parents are always first
+			tree.order.push_back(current);
 
-		for (int i = 0; i < shape->faces.size(); i++) {
-			vector<Vertex>* vertices = &(shape->faces[i]->mesh->vertices);
-			
-			for (int j = 0; j < vertices->size(); j++) {
-				glm::vec3 pos = (*vertices)[j].Position;
+			for (int e = adjacency->offsets[current]; e < adjacency->offsets[current + 1]; e++) {
+				int neighbor = adjacency->neighbors[e];
+				Face::Axis* axis = adjacency->hinge(current, e);
 
-				if (pos.x < minx) {
-					minx = pos.x;
+				if (done[neighbor]) {
+					continue;
 				}
-				if (pos.x > maxx) {
-					maxx = pos.x;
-				}
-				if (pos.z < miny) {
-					miny = pos.z;
+
+				// faces without a hinge between them stay rigid so just go straight across
+				float length = distance[current] + glm::distance(centers[current], centers[neighbor]);
+
+				if (axis != nullptr) {
+					glm::vec3 middle = (axis->p1 + axis->p2) * 0.5f;
+					length = distance[current] + glm::distance(centers[current], middle) + glm::distance(middle, centers[neighbor]);
 				}
-				if (pos.z > maxy) {
-					maxy = pos.z;
+
+				if (length < distance[neighbor]) {
+					distance[neighbor] = length;
+
+					tree.parent[neighbor] = current;
+					tree.parentEdge[neighbor] = e;
+
+					queue.push({ length, neighbor });
 				}
 			}
 		}
+	}
 
-		// reset shape to defualt shape and return
-		shape->revert();
+	// package a spanning tree as a solution graph (the graph comes from the shape so the nodes of old solutions are reused)
+	static Graph<Face>* toSolution(Shape* shape, SpanningTree &tree) {
+		return shape->faceAdjacency.graphFromTree(tree, shape->newSolution());
+	}
 
-		// output the bounds
-		//std::cout << "Calculated Bounds -- Minimum (-1, -1) Point: " + glm::to_string(glm::vec2(minx, miny)) + ", Maximum (1, 1) Point: " + glm::to_string(glm::vec2(maxx, maxy)) << std::endl;
-		return std::make_tuple(glm::vec2(minx,miny), glm::vec2(maxx,maxy));
+	// returns the spanning tree of a solution (uses the shape's cached tree for its current unfold)
+	static SpanningTree* treeOf(Shape* shape, Graph<Face>* graph, SpanningTree &scratch) {
+		if (graph == shape->unfold) {
+			return &shape->unfoldTree;
+		}
+
+		scratch = shape->faceAdjacency.treeFromGraph(graph);
+		scratch.buildChildren();
+		NetLayout::placePieces(&shape->faceAdjacency, scratch);
+
+		return &scratch;
 	}
 
-	// Functions to apply the unfold
+	// pose the shape with each face turned hingeProgress[face] of the way about the hinge to its parent (0.0-1.0)
+	// each face stores the hinge to its parent and the world transforms are composed from the root down in one pass,
+	// then every vertex is written once from the rest pose so no frame depends on the one before it
+	// the root of every other piece of a forest moves hingeProgress[root] of the way to its spot beside the first piece
+	static void evaluatePose(Shape* shape, SpanningTree* tree, vector<float> &hingeProgress) {
+		vector<glm::mat4> world(shape->faces.size(), glm::mat4(1.0f));
+
+		int piece = 0;
+
+		// parents come before their children in the order so each parent is done before it is used
+		for (int i = 1; i < tree->order.size(); i++) {
+			int face = tree->order[i];
+			int parent = tree->parent[face];
+
+			if (parent == -1) {
+				if (piece < tree->pieceTransforms.size()) {
+					glm::vec3 pivot = shape->faces[face]->mesh->backupVertices.empty() ? glm::vec3(0) : shape->faces[face]->mesh->backupVertices[0].Position;
+					world[face] = NetLayout::moveMatrix(tree->pieceTransforms[piece], pivot, hingeProgress[face]);
+				}
 
-	// Enter a pointer to the list of faces you want to generate and the current root node 
-	// The function will add all of the children of the entered node to the list
-	static void recursiveChildCompilation(vector<Face*>* list, Graph<Face>::Node* root) {
-		// add face of node
-		list->push_back(root->data);
+				piece++;
+				continue;
+			}
 
-		// process children of node
-		for (int i = 0; i < root->connections.size(); i++) {
-			recursiveChildCompilation(list, root->connections[i]);
+			world[face] = world[parent] * NetLayout::hingeMatrix(shape->faceAdjacency.hinge(parent, tree->parentEdge[face]), hingeProgress[face]);
 		}
+
+		shape->setPose(world);
 	}
 
-	// Enter the shape to manipulate and the root node of the generated unfold graph followed by the progress of the unfold (0.0-1.0)
-	// Automatically reverts the shape at the beginning of method
-	static void stepBasedUpdate(Shape* shape, Graph<Face>* graph, float progress) {
-		// set shape to default orientation before manipulation
-		shape->revert();
+	// random tree number index of a multi start run (depends on nothing but seed and index so it can be made again)
+	static void startTree(FaceAdjacency* adjacency, SpanningTree &tree, unsigned int seed, int index) {
+		seed_seq sequence{ seed, (unsigned int)index };
+		mt19937 random(sequence);
 
-		// begin manipulation
-		// the progress required for each level of faces to unfold
-		float miniProgress = 1.0f / graph->size;
+		// half of the starts grow depth first and half breadth first
+		if (index % 2 == 0) {
+			depthPopulation(adjacency, tree, &random);
+		}
+		else {
+			breadthPopulation(adjacency, tree, &random);
+		}
+	}
 
-		vector<Graph<Face>::Node*> queue;
+public:
+	static Graph<Face>* basic(Shape* shape) {
+		// init solution with the base 
+		SpanningTree tree;
+		depthPopulation(&shape->faceAdjacency, tree, nullptr);
 
-		queue.push_back(graph->rootNode);
+		return toSolution(shape, tree);
+	}
+
+	static Graph<Face>* randomBasic(Shape* shape) {
+		SpanningTree tree;
+		depthPopulation(&shape->faceAdjacency, tree, &threadRandom());
 
-		Graph<Face>::Node* current;
+		return toSolution(shape, tree);
+	}
 
-		int index = 0;
+	// the same seed always gives the same tree
+	static Graph<Face>* randomBasic(Shape* shape, unsigned int seed) {
+		mt19937 random(seed);
 
-		while (queue.size() <= floor(progress / miniProgress)) {
-			current = queue[index];
+		SpanningTree tree;
+		depthPopulation(&shape->faceAdjacency, tree, &random);
 
-			//std::cout << "New Animation Frame:" << std::endl;
+		return toSolution(shape, tree);
+	}
 
-			for (int i = 0; i < current->connections.size(); i++) {
-				queue.push_back(current->connections[i]);
-			}
+	static Graph<Face>* breadthUnfold(Shape* shape) {
+		SpanningTree tree;
+		breadthPopulation(&shape->faceAdjacency, tree, nullptr);
 
-			index += 1;
-		}
+		return toSolution(shape, tree);
+	}
 
-		// catchup all the queue indicies less than current
-		for (int z = 0; z < queue.size() && z != floor(progress / miniProgress); z++) {
-			current = queue[z];
+	static Graph<Face>* randomBreadthUnfold(Shape* shape) {
+		SpanningTree tree;
+		breadthPopulation(&shape->faceAdjacency, tree, &threadRandom());
 
-			// find axis
-			Face::Axis* axis = nullptr;
+		return toSolution(shape, tree);
+	}
 
-			for (int i = 0; i < current->connections.size(); i++) {
-				for (int x = 0; x < current->data->axis.size(); x++) {
-					if (current->data->axis[x]->neighborFace == current->connections[i]->data) {
-						axis = current->data->axis[x];
+	// the same seed always gives the same tree
+	static Graph<Face>* randomBreadthUnfold(Shape* shape, unsigned int seed) {
+		mt19937 random(seed);
 
-						//axis->print();
+		SpanningTree tree;
+		breadthPopulation(&shape->faceAdjacency, tree, &random);
 
-						break;
-					}
-				}
+		return toSolution(shape, tree);
+	}
 
-				// apply to children
-				if (axis != nullptr) {
-					// use the method to add all child faces attatched to the current face for the transformation of the shape.
-					vector<Face*> appliedFaces = vector<Face*>();
-					recursiveChildCompilation(&appliedFaces, current->connections[i]);
+	// builds count random trees spread over every core and keeps the one with the fewest overlapping face pairs
+	// (the smaller bounding area wins a tie, then the earlier tree), every tree is seeded from seed and its number alone so
+	// a seed gives the same net no matter how many cores there are
+	static Graph<Face>* multiStartUnfold(Shape* shape, int count = multiStartCount, unsigned int seed = multiStartSeed) {
+		auto start = std::chrono::steady_clock::now();
 
-					shape->transform(1 * (axis->originalAngle), axis, appliedFaces);
-				}
+		FaceAdjacency* adjacency = &shape->faceAdjacency;
+
+		vector<NetScore> scores(count);
+
+		ThreadPool pool;
+		pool.parallelFor(count, [&](int i) {
+			SpanningTree tree;
+			startTree(adjacency, tree, seed, i);
+			scores[i] = NetScore::measure(adjacency, tree);
+		});
+
+		int best = 0;
+		for (int i = 1; i < count; i++) {
+			if (scores[i].betterThan(scores[best])) {
+				best = i;
 			}
 		}
 
-		// handle latest update
-		current = queue[floor(progress / miniProgress)];
+		// only the scores were kept so make the winner again
+		SpanningTree tree;
+		startTree(adjacency, tree, seed, best);
 
-		// find axis
-		Face::Axis* axis = nullptr;
+		float time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "multi start: " << count << " trees on " << pool.size() << " threads in " << time << "s, best #" << best << " with " << scores[best].overlaps << " overlapping pairs" << std::endl;
 
-		for (int i = 0; i < current->connections.size(); i++) {
-			for (int x = 0; x < current->data->axis.size(); x++) {
-				if (current->data->axis[x]->neighborFace == current->connections[i]->data) {
-					axis = current->data->axis[x];
+		return toSolution(shape, tree);
+	}
 
-					//axis->print();
+	// cuts the shape into as few pieces as it can where each piece unfolds without overlapping (for shapes like the torus that have
+	// no single net), the pieces are set down next to the first one as they unfold
+	static Graph<Face>* segmentedUnfold(Shape* shape, int attempts = segmentAttempts, unsigned int seed = multiStartSeed) {
+		auto start = std::chrono::steady_clock::now();
 
-					break;
-				}
-			}
+		NetSegmentation::Result result = NetSegmentation::segment(&shape->faceAdjacency, attempts, seed);
 
-			// apply to children
-			if (axis != nullptr) {
-				// use the method to add all child faces attatched to the current face for the transformation of the shape.
-				vector<Face*> appliedFaces = vector<Face*>();
-				recursiveChildCompilation(&appliedFaces, current->connections[i]);
+		float time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "segmentation: " << result.pieces << " pieces (" << result.grownPieces << " before " << result.rounds << " rounds of joining) in " << time << "s" << std::endl;
 
-				shape->transform(1 * (axis->originalAngle) * (fmod(progress, miniProgress) / miniProgress), axis, appliedFaces);
-			}
-		}
+		return toSolution(shape, result.forest);
 	}
 
-	// Current working solution
-	// Enter the shape to manipulate and the root node of the generated unfold graph followed by the progress of the unfold (0.0-1.0)
-	// Automatically reverts the shape at the beginning of method
-	static void breadthFirstUpdate(Shape* shape, Graph<Face>* graph, float progress) {
-		// set shape to default orientation before manipulation
-		shape->revert();
+	// random partitions segmentedUnfold starts from
+	static constexpr int segmentAttempts = 64;
 
-		// begin manipulation
-		vector<Graph<Face>::Node*> queue;
+	// random trees multiStartUnfold builds and the seed they come from
+	static constexpr int multiStartCount = 256;
+	static constexpr unsigned int multiStartSeed = 1;
 
-		queue.push_back(graph->rootNode);
+	// cuts the steepest edges (every hinge is as level as it can be) which tends to unfold convex shapes without overlaps
+	static Graph<Face>* steepestEdgeUnfold(Shape* shape) {
+		SpanningTree tree;
+		vector<float> weights = hingeWeights(&shape->faceAdjacency, false);
+		weightedPopulation(&shape->faceAdjacency, tree, weights);
 
-		Graph<Face>::Node* current;
+		return toSolution(shape, tree);
+	}
 
-		// debugging tool to identify axis
-		int facesVisited = 0;
+	// the cut edges make a tree that is as level as it can be (the steep edges are the hinges)
+	static Graph<Face>* flatTreeUnfold(Shape* shape) {
+		SpanningTree tree;
+		vector<float> weights = hingeWeights(&shape->faceAdjacency, true);
+		weightedPopulation(&shape->faceAdjacency, tree, weights);
 
-		while (!queue.empty()) {
-			current = queue[0];
-			queue.erase(queue.begin());
+		return toSolution(shape, tree);
+	}
 
-			//std::cout << "New Animation Frame:" << std::endl;
+	// every face hangs from the base along its shortest walk across the surface
+	static Graph<Face>* shortestPathUnfold(Shape* shape) {
+		SpanningTree tree;
+		shortestPathPopulation(&shape->faceAdjacency, tree);
 
-			for (int i = 0; i < current->connections.size(); i++) {
-				facesVisited += 1;
+		return toSolution(shape, tree);
+	}
 
-				// find axis
-				Face::Axis* axis = nullptr;
+	// searches random spanning trees for one that unfolds without overlapping (returns the least overlapping tree if time runs out)
+	static Graph<Face>* overlapFreeUnfold(Shape* shape) {
+		auto start = std::chrono::steady_clock::now();
 
-				for (int x = 0; x < current->data->axis.size(); x++) {
-					if (current->data->axis[x]->neighborFace == current->connections[i]->data) {
-						axis = current->data->axis[x];
+		NetSearch::Result result = NetSearch::search(&shape->faceAdjacency, searchBudget);
 
-						//axis->print();
+		float time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "net search: " << result.candidates << " candidates in " << time << "s, " << result.overlaps << " overlapping pairs" << std::endl;
 
-						break;
-					}
-				}
+		return toSolution(shape, result.tree);
+	}
 
-				// apply to children
-				if (axis != nullptr) {
-					// use the method to add all child faces attatched to the current face for the transformation of the shape.
-					vector<Face*> appliedFaces = vector<Face*>();
-					recursiveChildCompilation(&appliedFaces, current->connections[i]);
+	// unfold along a tree found somewhere else (like a NetSearch running in the background)
+	static Graph<Face>* treeUnfold(Shape* shape, SpanningTree &tree) {
+		return toSolution(shape, tree);
+	}
 
-					// apply to the shape
-					shape->transform(1 * (axis->originalAngle) * progress, axis, appliedFaces);
+	// seconds overlapFreeUnfold may spend searching
+	static constexpr float searchBudget = 2.0f;
 
-					queue.push_back(current->connections[i]);
-				}
+	// returns the minimum and maximum corners of an unfold on a flat plane (returns "0,0 0,0" if there are no vertices)
+	// Shape must have an unfold Assigned!
+	// Assumes that the shape is rotated so the root unfold node is perfectly aligned with the xz plane
+	// the net is computed from the rest pose on the side so the shape is never touched and this can run while it is animating
+	static std::tuple<glm::vec2, glm::vec2> findUnfoldSize(Shape* shape) {
+		if (shape->unfold == nullptr) {
+			return std::make_tuple(glm::vec2(0), glm::vec2(0));
+		}
+
+		NetLayout layout(&shape->faceAdjacency);
+		layout.build(shape->unfoldTree, glm::vec3(0), glm::vec3(1, 0, 0), glm::vec3(0, 0, 1));
+
+		// output the bounds
+		//std::cout << "Calculated Bounds -- Minimum (-1, -1) Point: " + glm::to_string(std::get<0>(layout.findBounds())) + ", Maximum (1, 1) Point: " + glm::to_string(std::get<1>(layout.findBounds())) << std::endl;
+		return layout.findBounds();
+	}
+
+	// score the net of the shape's current unfold (see NetScore)
+	static NetScore scoreUnfold(Shape* shape) {
+		if (shape->unfold == nullptr) {
+			return NetScore();
+		}
+
+		return NetScore::measure(&shape->faceAdjacency, shape->unfoldTree);
+	}
+
+	// Functions to apply the unfold
+	// both work out the pose for progress from scratch so any progress can be shown in any order
+
+	// Enter the shape to manipulate and the root node of the generated unfold graph followed by the progress of the unfold (0.0-1.0)
+	static void stepBasedUpdate(Shape* shape, Graph<Face>* graph, float progress) {
+		SpanningTree scratch;
+		stepBasedUpdate(shape, treeOf(shape, graph, scratch), progress);
+	}
+
+	// each face in breadth first order unfolds all of its children before the next face starts
+	// (the next piece of a forest moves into place during the step of the last face of the piece before it)
+	static void stepBasedUpdate(Shape* shape, SpanningTree* tree, float progress) {
+		// nothing to unfold so hold the rest pose
+		if (tree->order.empty()) {
+			vector<float> hingeProgress(shape->faces.size(), 0.0f);
+			evaluatePose(shape, tree, hingeProgress);
+			return;
+		}
+
+		// the progress required for each level of faces to unfold
+		float miniProgress = 1.0f / tree->order.size();
+		int active = floor(progress / miniProgress);
+
+		// the children of every face before the active one are done, the active face's children are part way
+		vector<float> hingeProgress(shape->faces.size(), 0.0f);
+
+		for (int z = 0; z <= active && z < tree->order.size(); z++) {
+			int current = tree->order[z];
+
+			float fraction = 1.0f;
+			if (z == active) {
+				fraction = fmod(progress, miniProgress) / miniProgress;
+			}
+
+			for (int c = tree->childOffsets[current]; c < tree->childOffsets[current + 1]; c++) {
+				hingeProgress[tree->children[c]] = fraction;
+			}
+
+			if (z + 1 < tree->order.size() && tree->parent[tree->order[z + 1]] == -1) {
+				hingeProgress[tree->order[z + 1]] = fraction;
 			}
 		}
+
+		evaluatePose(shape, tree, hingeProgress);
 	}
-};
 
-template<class RandomIt>
-void random_shuffle(RandomIt first, RandomIt last)
-{
-	srand(time(NULL));
-	typename std::iterator_traits<RandomIt>::difference_type i, n;
-	n = last - first;
-	for (i = n - 1; i > 0; --i) {
-		using std::swap;
-		swap(first[i], first[std::rand() % (i + 1)]);
-		// rand() % (i+1) isn't actually correct, because the generated number
-		// is not uniformly distributed for most values of i. A correct implementation
-		// will need to essentially reimplement C++11 std::uniform_int_distribution,
-		// which is beyond the scope of this example.
+	// Current working solution
+	// Enter the shape to manipulate and the root node of the generated unfold graph followed by the progress of the unfold (0.0-1.0)
+	static void breadthFirstUpdate(Shape* shape, Graph<Face>* graph, float progress) {
+		SpanningTree scratch;
+		breadthFirstUpdate(shape, treeOf(shape, graph, scratch), progress);
 	}
-}
+
+	// every hinge unfolds at the same time
+	static void breadthFirstUpdate(Shape* shape, SpanningTree* tree, float progress) {
+		vector<float> hingeProgress(shape->faces.size(), progress);
+
+		evaluatePose(shape, tree, hingeProgress);
+	}
+};
 
 #endif
\ No newline at end of file
@@ -0,0 +1,102 @@
+#ifndef UNFOLDJOB_H
+#define UNFOLDJOB_H
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include "Shape.h"
+#include "NetSearch.h"
+
+using namespace std;
+
+// a net search for one shape that runs on its own thread so the window keeps drawing while it looks
+// the best tree so far can be taken at any time (to accept a good enough net early) and cancel stops the search
+// only the shape's face adjacency is read while it runs, which never changes after the shape is loaded
+class UnfoldJob {
+public:
+	// budget is in seconds
+	UnfoldJob(Shape* shape, float budget) {
+		this->shape = shape;
+		this->budget = budget;
+
+		start = chrono::steady_clock::now();
+
+		worker = thread([this]() {
+			NetSearch::search(&this->shape->faceAdjacency, this->budget, searchThreads(), &progress);
+			done = true;
+		});
+	}
+
+	~UnfoldJob() {
+		stop();
+	}
+
+	UnfoldJob(const UnfoldJob&) = delete;
+	UnfoldJob& operator=(const UnfoldJob&) = delete;
+
+	// ask the search to stop (returns right away, the workers stop after the step they are on)
+	void cancel() {
+		progress.cancelled = true;
+	}
+
+	// cancel and wait for the workers to let go of the shape
+	void stop() {
+		cancel();
+
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+
+	// the search found an overlap free net, ran out of time or was cancelled
+	bool finished() {
+		return done;
+	}
+
+	// share of the time budget used so far (1 once the search is over)
+	float getProgress() {
+		if (done) {
+			return 1;
+		}
+
+		float elapsed = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+		return budget > 0 ? min(elapsed / budget, 1.0f) : 1.0f;
+	}
+
+	// best tree so far (overlaps is -1 if no tree is done yet)
+	NetSearch::Result getBest() {
+		return progress.getBest();
+	}
+
+	// overlapping pairs in the best tree so far without copying it
+	int getBestOverlaps() {
+		return progress.bestOverlaps;
+	}
+
+	int getCandidates() {
+		return progress.candidates;
+	}
+
+	Shape* getShape() {
+		return shape;
+	}
+
+private:
+	Shape* shape;
+	float budget;
+
+	chrono::steady_clock::time_point start;
+
+	thread worker;
+	NetSearch::Progress progress;
+	atomic<bool> done{ false };
+
+	// one core is left for the window and the animator
+	static int searchThreads() {
+		return max(1, (int)thread::hardware_concurrency() - 1);
+	}
+};
+
+#endif
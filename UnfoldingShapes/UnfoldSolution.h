@@ -16,9 +16,10 @@ using namespace std;
 
 class UnfoldSolution {
 public:
-	Graph<Face> solution;
+	// owned by the shape it was generated for
+	Graph<Face>* solution;
 
-	UnfoldSolution(Graph<Face> solution) {
+	UnfoldSolution(Graph<Face>* solution) {
 		this->solution = solution;
 	}
 
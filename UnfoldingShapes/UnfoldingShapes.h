@@ -12,6 +12,7 @@
 
 #include "Shape.h"
 #include "Animator.h"
+#include "UnfoldJob.h"
 
 class UnfoldingShapes : public QMainWindow
 {
@@ -40,10 +41,21 @@ public:
 		// render menu connections
 		connect(ui.enableTable, &QCheckBox::stateChanged, this, &UnfoldingShapes::checkTable);
 
+		// background net search
+		searchTimer = new QTimer(this);
+		connect(searchTimer, &QTimer::timeout, this, &UnfoldingShapes::checkSearch);
+		connect(ui.acceptUnfold, &QPushButton::released, this, &UnfoldingShapes::acceptSearch);
+		ui.acceptUnfold->setEnabled(false);
+
 		// enable controls
 		ui.openGLWidget->installEventFilter(this);
 	}
 
+	~UnfoldingShapes() {
+		// the search threads must not outlive the shape they read
+		cancelSearch();
+	}
+
 	OpenGLWidget* getGraphics() {
 		return ui.openGLWidget;
 	}
@@ -166,6 +178,9 @@ public:
 
 	// assumes shape pointer is already added to the shapes list
 	void focusShape(Shape* shape) {
+		// a search for the last shape is no use anymore
+		cancelSearch();
+
 		// check if the client is emptying the focus shape
 		if (shape == nullptr) {
 			focusedShape = nullptr;
@@ -175,6 +190,9 @@ public:
 		// move the current focus back to its position
 		//backboard->applyTransform();
 
+		// the shapes are about to change so let the animator finish posing them
+		animator->finish();
+
 		// stop current animation of the focused shape
 		if (focusedShape != nullptr) {
 			animator->getAnimation(focusedShape)->stop();
@@ -198,30 +216,122 @@ public:
 		if (focusedShape != nullptr) {
 			Shape* current = focusedShape;
 
+			cancelSearch();
+
+			animator->finish();
+
 			int unfoldSetting = ui.unfoldMethodInput->currentIndex();
-			int animationSetting = ui.animationMethodInput->currentIndex();
-			float speed = ui.speedInput->value();
-			float scale = ui.scaleInput->value();
+
+			// the search can take a while so it runs in the background and the current net keeps playing until it is done
+			if (unfoldSetting == searchSetting) {
+				startSearch(current);
+				return;
+			}
 
 			setUnfold(current, unfoldSetting);
 
-			// align the y position correctly
-			focusedShape->asset->position = origin - focusedShape->getBasePos();
+			playUnfold(current);
+		}
+	}
+
+	// lay the shape's net out on the table and start unfolding it with the settings in the menu
+	void playUnfold(Shape* shape) {
+		int animationSetting = ui.animationMethodInput->currentIndex();
+		float speed = ui.speedInput->value();
 
-			// measure unfold bounds to adjust position to
-			orientUnfoldShape(current, glm::vec2(origin.x, origin.y) - (tableBounds * 0.5f), glm::vec2(origin.x, origin.y) + (tableBounds * 0.5f));
+		std::cout << shape->name << " net: ";
+		Unfold::scoreUnfold(shape).print();
 
-			// startup animator
-			Animator::Animation* animation = animator->getAnimation(current);
-			animation->setAlgorithm(animationSetting);
-			animation->speed = speed;
+		// align the y position correctly
+		shape->asset->setPosition(origin - shape->getBasePos());
 
-			animation->progress = 0;
+		// measure unfold bounds to adjust position to
+		orientUnfoldShape(shape, glm::vec2(origin.x, origin.y) - (tableBounds * 0.5f), glm::vec2(origin.x, origin.y) + (tableBounds * 0.5f));
 
-			animation->play();
+		// startup animator
+		Animator::Animation* animation = animator->getAnimation(shape);
+		animation->setAlgorithm(animationSetting);
+		animation->speed = speed;
+
+		animation->progress = 0;
+
+		animation->play();
+	}
+
+	// background net search
+	void startSearch(Shape* shape) {
+		search = new UnfoldJob(shape, searchBudget);
+
+		std::cout << shape->name << ": searching for an overlap free net for up to " << searchBudget << "s" << std::endl;
+
+		ui.unfoldProgress->setValue(0);
+		ui.unfoldProgress->setFormat("%p%");
+		ui.acceptUnfold->setEnabled(true);
+
+		searchTimer->start(searchPollMS);
+	}
+
+	// show how far the search got and take its net once it is done
+	void checkSearch() {
+		if (search == nullptr) {
+			return;
+		}
+
+		ui.unfoldProgress->setValue((int)(search->getProgress() * 100));
+
+		int overlaps = search->getBestOverlaps();
+		if (overlaps != -1) {
+			ui.unfoldProgress->setFormat(QString("%p% (%1 overlaps)").arg(overlaps));
+		}
+
+		if (search->finished()) {
+			acceptSearch();
 		}
 	}
 
+	// stop the search and unfold the best net it has found so far
+	void acceptSearch() {
+		if (search == nullptr) {
+			return;
+		}
+
+		search->stop();
+
+		Shape* shape = search->getShape();
+		NetSearch::Result best = search->getBest();
+
+		std::cout << "net search: " << search->getCandidates() << " candidates, " << best.overlaps << " overlapping pairs" << std::endl;
+
+		cancelSearch();
+
+		// nothing was done in time, keep the net that is there
+		if (best.overlaps == -1) {
+			return;
+		}
+
+		animator->finish();
+
+		shape->setUnfold(Unfold::treeUnfold(shape, best.tree));
+
+		playUnfold(shape);
+	}
+
+	// drop the search (waits for its threads to stop)
+	void cancelSearch() {
+		if (search == nullptr) {
+			return;
+		}
+
+		delete search;
+		search = nullptr;
+
+		searchTimer->stop();
+
+		ui.unfoldProgress->setValue(0);
+		ui.unfoldProgress->setFormat("%p%");
+		ui.acceptUnfold->setEnabled(false);
+	}
+
 	void selectFile() {
 		QString fileName = QFileDialog::getOpenFileName(this, tr("Open Shape"), "", tr("OBJ File (*.obj)"));
 
@@ -387,7 +497,6 @@ public:
 		shape->asset->setPosition(shape->asset->position * glm::vec3(1.0f, scaleFactor, 1.0f));
 
 		//std::cout << std::endl << "Final Bounds at pos " << glm::to_string(shape->asset->position) << " and a scale factor of " << scaleFactor << std::endl;
-		Unfold::findUnfoldSize(shape);
 	}
 
 	void setupBackBoard() {
@@ -422,6 +531,24 @@ public:
 		case 3:
 			shape->setUnfold(Unfold::randomBreadthUnfold(shape));
 			break;
+		case 4:
+			shape->setUnfold(Unfold::overlapFreeUnfold(shape));
+			break;
+		case 5:
+			shape->setUnfold(Unfold::steepestEdgeUnfold(shape));
+			break;
+		case 6:
+			shape->setUnfold(Unfold::flatTreeUnfold(shape));
+			break;
+		case 7:
+			shape->setUnfold(Unfold::shortestPathUnfold(shape));
+			break;
+		case 8:
+			shape->setUnfold(Unfold::multiStartUnfold(shape));
+			break;
+		case 9:
+			shape->setUnfold(Unfold::segmentedUnfold(shape));
+			break;
 		default:
 			return false;
 			break;
@@ -527,6 +654,17 @@ private:
 	// viewer pointers
 	Shape* focusedShape;
 
+	// background net search (nullptr when none is running)
+	UnfoldJob* search = nullptr;
+	QTimer* searchTimer;
+
+	// unfold menu entry that runs the search in the background
+	static constexpr int searchSetting = 4;
+
+	// seconds the background search may take, it stops sooner as soon as it finds an overlap free net
+	static constexpr float searchBudget = 30.0f;
+	int searchPollMS = 100;
+
 	//Backboard* backboard;
 
 	// camera settings
@@ -0,0 +1,72 @@
+#ifndef UNIFORMBUFFER_H
+#define UNIFORMBUFFER_H
+
+#include <QtWidgets/qopenglwidget.h>
+#include <QtGui/qopenglfunctions_3_3_core.h>
+
+#include <glm/glm.hpp>
+
+#include "StreamBuffer.h"
+
+#include <iostream>
+
+// camera and light data shared by every draw of a frame
+// laid out to match the std140 "Frame" block in the model shaders (vec3s take the room of a vec4)
+struct FrameUniforms {
+	glm::mat4 projection;
+	glm::mat4 view;
+
+	glm::vec4 viewPos;
+
+	glm::vec4 lightPos;
+	glm::vec4 lightColor;
+	float lightBrightness;
+	float lightDistance;
+	int enableLighting;
+	float padding;
+};
+
+// a uniform buffer bound to a fixed binding point that any number of shaders can read from
+// (connect a shader's block with Shader::bindUniformBlock and the same binding)
+template <typename T>
+class UniformBuffer {
+public:
+	UniformBuffer() {
+
+	}
+
+	UniformBuffer(QOpenGLFunctions_3_3_Core **f, unsigned int binding) {
+		this->f = f;
+		this->binding = binding;
+
+		(*f)->glGenBuffers(1, &buffer);
+
+		(*f)->glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		(*f)->glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+		(*f)->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		(*f)->glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+	}
+
+	// replace the whole block
+	void upload(const T &data) {
+		(*f)->glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		(*f)->glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+		(*f)->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		UploadStats::bytes += sizeof(T);
+		UploadStats::uploads++;
+	}
+
+	unsigned int getBinding() {
+		return binding;
+	}
+
+private:
+	QOpenGLFunctions_3_3_Core **f;
+
+	unsigned int buffer = 0;
+	unsigned int binding = 0;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec3 tangent;
+layout (location = 5) in int aFaceId;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+uniform mat4 model;
+
+//camera and light data shared by every draw of a frame (see FrameUniforms)
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+    float lightBrightness;
+    float lightDistance;
+    bool enableLighting;
+};
+
+//rest pose -> current pose of every face (4 texels per matrix, one column each)
+uniform samplerBuffer faceTransforms;
+
+mat4 getFaceTransform(int face)
+{
+    return mat4(texelFetch(faceTransforms, face * 4), texelFetch(faceTransforms, face * 4 + 1), texelFetch(faceTransforms, face * 4 + 2), texelFetch(faceTransforms, face * 4 + 3));
+}
+
+void main()
+{
+    //the face transform is rigid so it can turn the normal directly
+    mat4 faceTransform = getFaceTransform(aFaceId);
+    mat4 world = model * faceTransform;
+
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * world * vec4(aPos, 1.0);
+
+    Normal = transpose(inverse(mat3(model))) * (mat3(faceTransform) * aNormal);
+
+    FragPos = vec3(world * vec4(aPos, 1.0));
+}
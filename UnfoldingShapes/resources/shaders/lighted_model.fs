@@ -14,15 +14,18 @@ uniform vec3 overrideColor = vec3(1.0);
 uniform vec3 effectColor = vec3(1.0,1.0,1.0);
 uniform float effectColorStrength = 0;
 
-//light info
-uniform bool enableLighting = false;
-uniform vec3 lightPos;
-uniform vec3 lightColor;
-uniform float lightBrightness;
-uniform float lightDistance;
-
-//camera data
-uniform vec3 viewPos;
+//camera and light data shared by every draw of a frame (see FrameUniforms)
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+    float lightBrightness;
+    float lightDistance;
+    bool enableLighting;
+};
 
 //textures
 uniform bool hasDiffuseTex = false;
@@ -85,20 +88,20 @@ void main()
 
     	//ambient lighting
 		float ambientStrength = 0.3;
-    	vec3 ambient = ambientStrength * (lightColor * ambient_color);
+    	vec3 ambient = ambientStrength * (lightColor.xyz * ambient_color);
 
     	//diffuse lighting (normals)
 		vec3 norm = normalize(Normal);
-		vec3 lightDir = normalize(lightPos - FragPos);
+		vec3 lightDir = normalize(lightPos.xyz - FragPos);
 		diff = max(dot(norm, lightDir), 0.0);
-		vec3 diffuse = diff * lightColor * diffuse_color;
+		vec3 diffuse = diff * lightColor.xyz * diffuse_color;
 
 		//specular lighting
 		//basically just make the surface brighter if more light reflects more into the viewers eyes
-    	vec3 viewDir = normalize(viewPos - FragPos);
+    	vec3 viewDir = normalize(viewPos.xyz - FragPos);
     	vec3 reflectDir = reflect(-lightDir, norm);  
     	float spec = pow(max(dot(viewDir, reflectDir), 0.0), specular_shine);
-    	vec3 specular = 1 * spec * (lightColor * specular_color); 
+    	vec3 specular = 1 * spec * (lightColor.xyz * specular_color); 
     	//(EDIT) removed specular_strength where 1 is because it was recieved invalid many times
 
     	//combine the lighting output colors
@@ -9,8 +9,19 @@ out vec3 Normal;
 out vec2 TexCoords;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+//camera and light data shared by every draw of a frame (see FrameUniforms)
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+    float lightBrightness;
+    float lightDistance;
+    bool enableLighting;
+};
 
 void main()
 {